@@ -0,0 +1,216 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file allocation_counter.hpp
+   \brief allocation_counter.hpp counts the heap allocations of the experiments per phase.
+   \author Simon Gog
+*/
+#ifndef ALLOCATION_COUNTER
+#define ALLOCATION_COUNTER
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <string>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <sdsl/memory_management.hpp>
+
+// With COUNT_ALLOCATIONS defined (make COUNT_ALLOCATIONS=1) this header
+// replaces the global operator new and delete. Include it in exactly one
+// translation unit of a program, i.e. in the experiment driver. The counters
+// are shared atomics, so counting slows down every allocation and makes
+// threads allocating in parallel contend; the timings of such a build are
+// not comparable with those of a plain one. Without the flag only the
+// int_vector memory of memory_monitor is tracked.
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+#ifdef COUNT_ALLOCATIONS
+namespace allocation_counter_detail
+{
+
+std::atomic<uint64_t> allocations(0);
+std::atomic<uint64_t> allocated_bytes(0);
+std::atomic<uint64_t> live_bytes(0);
+std::atomic<uint64_t> peak_bytes(0);
+std::atomic<uint64_t> base_bytes(0);
+
+//! Usable size of the block p, or 0 where the C library cannot tell.
+inline uint64_t block_size(void *p)
+{
+#ifdef __GLIBC__
+    return malloc_usable_size(p);
+#else
+    (void)p;
+    return 0;
+#endif
+}
+
+inline void *allocate(std::size_t size)
+{
+    void *p = std::malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        return nullptr;
+    }
+    uint64_t bytes = block_size(p);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(bytes ? bytes : size, std::memory_order_relaxed);
+    uint64_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+    return p;
+}
+
+inline void deallocate(void *p)
+{
+    if (p != nullptr)
+    {
+        live_bytes.fetch_sub(block_size(p), std::memory_order_relaxed);
+        std::free(p);
+    }
+}
+
+} // end namespace allocation_counter_detail
+#endif
+
+//! Heap usage of one measured phase.
+struct heap_sample
+{
+    uint64_t allocations = 0;           //!< Calls of operator new.
+    uint64_t allocated_bytes = 0;       //!< Bytes allocated by operator new.
+    uint64_t peak_heap_bytes = 0;       //!< Peak of the bytes held through operator new, above the start of the phase.
+    uint64_t peak_int_vector_bytes = 0; //!< Peak of the int_vector memory reported by memory_monitor.
+
+    //! Print prefix Allocations, Allocated, PeakHeap and PeakIntVector, the last three in MiB.
+    /*! The first three only with COUNT_ALLOCATIONS.
+     */
+    void print(std::ostream &out, const std::string &prefix) const
+    {
+        const double mib = 1024.0 * 1024.0;
+#ifdef COUNT_ALLOCATIONS
+        out << " " << prefix << "Allocations=" << allocations
+            << " " << prefix << "Allocated=" << allocated_bytes / mib
+            << " " << prefix << "PeakHeap=" << peak_heap_bytes / mib;
+#endif
+        out << " " << prefix << "PeakIntVector=" << peak_int_vector_bytes / mib;
+    }
+};
+
+//! Heap accounting of a phase.
+/*! operator new, counted with COUNT_ALLOCATIONS, covers the containers of
+ *  the STL and of rlcsa, while the memory of int_vector is allocated by
+ *  sdsl's memory_manager, which reports to memory_monitor instead. Both are
+ *  tracked, since a structure built from int_vectors would otherwise look
+ *  free. Phases must not overlap.
+ */
+class heap_monitor
+{
+  public:
+    //! Reset the counters and start memory_monitor.
+    static void start()
+    {
+#ifdef COUNT_ALLOCATIONS
+        using namespace allocation_counter_detail;
+        uint64_t live = live_bytes.load();
+        base_bytes = live;
+        peak_bytes = live;
+        allocations = 0;
+        allocated_bytes = 0;
+#endif
+        memory_monitor::start();
+    }
+
+    //! Stop memory_monitor and return the usage since start().
+    /*! The event log of memory_monitor stays available for
+     *  memory_monitor::write_memory_log until the next start().
+     */
+    static heap_sample stop()
+    {
+        memory_monitor::stop();
+        heap_sample sample;
+#ifdef COUNT_ALLOCATIONS
+        using namespace allocation_counter_detail;
+        sample.allocations = allocations.load();
+        sample.allocated_bytes = allocated_bytes.load();
+        sample.peak_heap_bytes = peak_bytes.load() - base_bytes.load();
+#endif
+        int64_t int_vector_peak = memory_monitor::peak();
+        sample.peak_int_vector_bytes = int_vector_peak > 0 ? static_cast<uint64_t>(int_vector_peak) : 0;
+        return sample;
+    }
+};
+
+} // end namespace sdsl
+
+#ifdef COUNT_ALLOCATIONS
+void *operator new(std::size_t size)
+{
+    void *p = sdsl::allocation_counter_detail::allocate(size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return sdsl::allocation_counter_detail::allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return sdsl::allocation_counter_detail::allocate(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    sdsl::allocation_counter_detail::deallocate(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    sdsl::allocation_counter_detail::deallocate(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    sdsl::allocation_counter_detail::deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    sdsl::allocation_counter_detail::deallocate(p);
+}
+#endif
+
+#endif
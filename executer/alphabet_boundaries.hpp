@@ -0,0 +1,287 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file alphabet_boundaries.hpp
+   \brief alphabet_boundaries.hpp contains the bucket boundary structures of the psi vectors.
+   \author Simon Gog
+*/
+#ifndef ALPHABET_BOUNDARIES
+#define ALPHABET_BOUNDARIES
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/hyb_sd_vector.hpp>
+#include <sdsl/rank_support.hpp>
+#include <sdsl/select_support.hpp>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Bucket boundaries of a psi vector for small alphabets.
+/*! The bucket starts are kept in a fixed size C-array of about
+ *  t_max_buckets words, 272 words or 2.1 KB for 257 buckets. A bucket is
+ *  found by counting the starts <= i, first in a directory of at most 16
+ *  group starts and then inside one group. Both loops have a fixed trip
+ *  count and no data-dependent branches, so the compiler vectorizes them.
+ *  The directory fills at most two cache lines, so a lookup touches two
+ *  lines for the directory and at most three for a group of 17 starts.
+ *
+ *  \tparam t_max_buckets Maximal number of buckets, 257 covers a byte
+ *                        alphabet plus the sentinel.
+ */
+template <uint32_t t_max_buckets = 257>
+class small_alphabet_boundaries
+{
+  public:
+    typedef int_vector<>::size_type size_type;
+
+  private:
+    static const size_type directory_size = 16; // group starts in two cache lines
+    static const size_type group_size = (t_max_buckets + 1 + directory_size - 1) / directory_size;
+    static const size_type groups = (t_max_buckets + 1 + group_size - 1) / group_size;
+
+    size_type m_size = 0; // number of buckets
+    alignas(64) uint64_t m_group_starts[groups];
+    alignas(64) uint64_t m_starts[groups * group_size];
+
+    void init()
+    {
+        for (size_type g = 0; g < groups; ++g)
+        {
+            m_group_starts[g] = m_starts[g * group_size];
+        }
+    }
+
+  public:
+    small_alphabet_boundaries()
+    {
+        std::fill(m_starts, m_starts + groups * group_size, std::numeric_limits<uint64_t>::max());
+        init();
+    }
+
+    //! Constructor for the alphabet marker.
+    /*! \param marker Bit vector of length n+1 with the bucket starts and n set.
+         */
+    small_alphabet_boundaries(const bit_vector &marker) : small_alphabet_boundaries()
+    {
+        size_type k = 0;
+        for (size_type i = 0; i < marker.size(); ++i)
+        {
+            if (marker[i])
+            {
+                if (k == t_max_buckets + 1)
+                {
+                    throw std::length_error("small_alphabet_boundaries: more than " + std::to_string(t_max_buckets) + " buckets, use sd_alphabet_boundaries");
+                }
+                m_starts[k++] = i;
+            }
+        }
+        m_size = k - 1;
+        init();
+    }
+
+    //! Constructor for the bucket starts.
+    /*! \param starts Increasing bucket starts, followed by n.
+         */
+    explicit small_alphabet_boundaries(const std::vector<uint64_t> &starts) : small_alphabet_boundaries()
+    {
+        if (starts.size() > t_max_buckets + 1)
+        {
+            throw std::length_error("small_alphabet_boundaries: more than " + std::to_string(t_max_buckets) + " buckets, use sd_alphabet_boundaries");
+        }
+        std::copy(starts.begin(), starts.end(), m_starts);
+        m_size = starts.size() - 1;
+        init();
+    }
+
+    //! Number of buckets.
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    //! Bucket containing position i.
+    size_type bucket(size_type i) const
+    {
+        size_type g = 0;
+        for (size_type k = 1; k < groups; ++k)
+        {
+            g += (m_group_starts[k] <= i);
+        }
+        const uint64_t *starts = m_starts + g * group_size;
+        size_type c = 0;
+        for (size_type k = 1; k < group_size; ++k)
+        {
+            c += (starts[k] <= i);
+        }
+        return g * group_size + c;
+    }
+
+    //! First position of bucket c, start(size()) is the length of the vector.
+    size_type start(size_type c) const
+    {
+        return m_starts[c];
+    }
+
+    size_type serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+    {
+        structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += write_member(m_size, out, child, "size");
+        for (size_type c = 0; c <= m_size; ++c)
+        {
+            written_bytes += write_member(m_starts[c], out, child, "start");
+        }
+        structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream &in)
+    {
+        std::fill(m_starts, m_starts + groups * group_size, std::numeric_limits<uint64_t>::max());
+        read_member(m_size, in);
+        for (size_type c = 0; c <= m_size; ++c)
+        {
+            read_member(m_starts[c], in);
+        }
+        init();
+    }
+};
+
+//! Bucket boundaries of a psi vector stored in a sparse bit vector.
+/*! For large integer alphabets; a lookup costs one rank and one select.
+ *  \tparam t_bv Bit vector for the alphabet marker, e.g. sd_vector<> or hyb_sd_vector<>.
+ */
+template <class t_bv = sd_vector<>>
+class sd_alphabet_boundaries
+{
+  public:
+    typedef int_vector<>::size_type size_type;
+    typedef typename t_bv::rank_1_type rank_support;
+    typedef typename t_bv::select_1_type select_support;
+
+  private:
+    size_type m_size = 0; // number of buckets
+    t_bv m_alphabet_marker;
+    rank_support m_alphabet_rank;
+    select_support m_alphabet_select;
+
+    static t_bv build_marker(const std::vector<uint64_t> &starts, std::true_type)
+    {
+        return t_bv(starts.begin(), starts.end());
+    }
+
+    static t_bv build_marker(const std::vector<uint64_t> &starts, std::false_type)
+    {
+        bit_vector marker(starts.back() + 1, 0);
+        for (uint64_t start : starts)
+        {
+            marker[start] = 1;
+        }
+        return t_bv(marker);
+    }
+
+  public:
+    sd_alphabet_boundaries() = default;
+
+    sd_alphabet_boundaries(const sd_alphabet_boundaries &b) : m_size(b.m_size), m_alphabet_marker(b.m_alphabet_marker)
+    {
+        m_alphabet_rank = rank_support(&m_alphabet_marker);
+        m_alphabet_select = select_support(&m_alphabet_marker);
+    }
+
+    sd_alphabet_boundaries &operator=(const sd_alphabet_boundaries &b)
+    {
+        if (this != &b)
+        {
+            m_size = b.m_size;
+            m_alphabet_marker = b.m_alphabet_marker;
+            m_alphabet_rank = rank_support(&m_alphabet_marker);
+            m_alphabet_select = select_support(&m_alphabet_marker);
+        }
+        return *this;
+    }
+
+    //! Constructor for the alphabet marker.
+    /*! \param marker Bit vector of length n+1 with the bucket starts and n set.
+         */
+    sd_alphabet_boundaries(const bit_vector &marker) : m_alphabet_marker(marker)
+    {
+        m_alphabet_rank = rank_support(&m_alphabet_marker);
+        m_alphabet_select = select_support(&m_alphabet_marker);
+        m_size = m_alphabet_rank(marker.size()) - 1;
+    }
+
+    //! Constructor for the bucket starts.
+    /*! \param starts Increasing bucket starts, followed by n.
+     *  A t_bv with a constructor for a sorted range of positions, like
+     *  sd_vector<>, is built without a bit vector of length n. Otherwise,
+     *  e.g. for hyb_sd_vector<>, the marker is set in a temporary bit_vector.
+         */
+    explicit sd_alphabet_boundaries(const std::vector<uint64_t> &starts)
+        : m_size(starts.size() - 1),
+          m_alphabet_marker(build_marker(starts, std::is_constructible<t_bv, std::vector<uint64_t>::const_iterator, std::vector<uint64_t>::const_iterator>()))
+    {
+        m_alphabet_rank = rank_support(&m_alphabet_marker);
+        m_alphabet_select = select_support(&m_alphabet_marker);
+    }
+
+    //! Number of buckets.
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    //! Bucket containing position i.
+    size_type bucket(size_type i) const
+    {
+        return m_alphabet_rank(i + 1) - 1;
+    }
+
+    //! First position of bucket c, start(size()) is the length of the vector.
+    size_type start(size_type c) const
+    {
+        return m_alphabet_select(c + 1);
+    }
+
+    size_type serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+    {
+        structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += write_member(m_size, out, child, "size");
+        written_bytes += m_alphabet_marker.serialize(out, child, "alphabet marker");
+        structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream &in)
+    {
+        read_member(m_size, in);
+        m_alphabet_marker.load(in);
+        m_alphabet_rank = rank_support(&m_alphabet_marker);
+        m_alphabet_select = select_support(&m_alphabet_marker);
+    }
+};
+
+} // end namespace sdsl
+#endif
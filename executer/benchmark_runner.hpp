@@ -0,0 +1,441 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file benchmark_runner.hpp
+   \brief benchmark_runner.hpp contains the command line options, the experiment registry and the result formats of the experiment runner.
+   \author Simon Gog
+*/
+#ifndef BENCHMARK_RUNNER
+#define BENCHMARK_RUNNER
+
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Command line of the runner.
+/*! Options are given as --key value or --key=value, anywhere between the
+ *  positional arguments. Keys listed in flags take no value.
+ */
+class benchmark_options
+{
+  private:
+    std::map<std::string, std::string> m_values;
+    std::vector<std::string> m_positional;
+
+  public:
+    benchmark_options(int argc, char *argv[], const std::set<std::string> &flags)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg.size() < 3 || arg.compare(0, 2, "--") != 0)
+            {
+                m_positional.push_back(arg);
+                continue;
+            }
+            std::string key = arg.substr(2);
+            size_t eq = key.find('=');
+            if (eq != std::string::npos)
+            {
+                m_values[key.substr(0, eq)] = key.substr(eq + 1);
+            }
+            else if (flags.count(key))
+            {
+                m_values[key] = "1";
+            }
+            else if (i + 1 < argc)
+            {
+                m_values[key] = argv[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("option --" + key + " needs a value");
+            }
+        }
+    }
+
+    const std::vector<std::string> &positional() const
+    {
+        return m_positional;
+    }
+
+    bool has(const std::string &key) const
+    {
+        return m_values.count(key) > 0;
+    }
+
+    //! Value of --key converted to T, or def if the option is not given.
+    template <class T>
+    T get(const std::string &key, T def) const
+    {
+        auto it = m_values.find(key);
+        if (it == m_values.end())
+        {
+            return def;
+        }
+        std::istringstream in(it->second);
+        T value;
+        if (!(in >> value) || !(in >> std::ws).eof())
+        {
+            throw std::invalid_argument("invalid value '" + it->second + "' for option --" + key);
+        }
+        return value;
+    }
+
+    //! Comma separated values of --key.
+    std::vector<std::string> list(const std::string &key) const
+    {
+        std::vector<std::string> values;
+        auto it = m_values.find(key);
+        if (it != m_values.end())
+        {
+            std::istringstream in(it->second);
+            std::string value;
+            while (std::getline(in, value, ','))
+            {
+                if (!value.empty())
+                {
+                    values.push_back(value);
+                }
+            }
+        }
+        return values;
+    }
+};
+
+//! Match name against pattern, where * matches any sequence of characters.
+inline bool glob_match(const char *pattern, const char *name)
+{
+    if (*pattern == '\0')
+    {
+        return *name == '\0';
+    }
+    if (*pattern == '*')
+    {
+        return glob_match(pattern + 1, name) || (*name != '\0' && glob_match(pattern, name + 1));
+    }
+    return *pattern == *name && glob_match(pattern + 1, name + 1);
+}
+
+//! Named experiments of the runner.
+/*! Every experiment belongs to a group and is identified by group/name.
+ *  Groups not marked as default only run if they are selected.
+ */
+class experiment_registry
+{
+  public:
+    struct entry
+    {
+        std::string group;
+        std::string name;
+        std::function<void()> run;
+        std::function<void()> prepare; //!< Builds the inputs of run once, before the warmup runs; may be empty.
+
+        std::string id() const
+        {
+            return group + "/" + name;
+        }
+    };
+
+  private:
+    std::vector<entry> m_entries;
+    std::set<std::string> m_default_groups;
+
+  public:
+    void add(const std::string &group, const std::string &name, std::function<void()> run,
+             std::function<void()> prepare = std::function<void()>())
+    {
+        for (auto &e : m_entries)
+        {
+            if (e.group == group && e.name == name)
+            {
+                throw std::logic_error("experiment " + group + "/" + name + " is registered twice");
+            }
+        }
+        m_entries.push_back({group, name, std::move(run), std::move(prepare)});
+    }
+
+    //! Run the experiments of group if nothing is selected.
+    void set_default_group(const std::string &group)
+    {
+        m_default_groups.insert(group);
+    }
+
+    //! Experiments matching any of patterns, in registration order.
+    /*! A pattern matches a group, or the id group/name with * as wildcard.
+     *  all selects every experiment, no pattern the default groups.
+     */
+    std::vector<const entry *> select(const std::vector<std::string> &patterns) const
+    {
+        std::vector<const entry *> selected;
+        std::vector<bool> used(patterns.size(), false);
+        for (auto &e : m_entries)
+        {
+            bool match = patterns.empty() && m_default_groups.count(e.group);
+            for (size_t i = 0; i < patterns.size(); ++i)
+            {
+                if (patterns[i] == "all" || patterns[i] == e.group || glob_match(patterns[i].c_str(), e.id().c_str()))
+                {
+                    match = true;
+                    used[i] = true;
+                }
+            }
+            if (match)
+            {
+                selected.push_back(&e);
+            }
+        }
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            if (!used[i])
+            {
+                throw std::invalid_argument("no experiment matches '" + patterns[i] + "', see --list");
+            }
+        }
+        return selected;
+    }
+
+    void list(std::ostream &out) const
+    {
+        for (auto &e : m_entries)
+        {
+            out << e.id() << (m_default_groups.count(e.group) ? "" : " (not run by default)") << "\n";
+        }
+    }
+};
+
+//! Stream buffer rewriting the RESULT lines of the experiments.
+/*! The experiments write RESULT key=value ... lines. This buffer adds the
+ *  fields of set_fields() after RESULT and writes the line in the chosen
+ *  format:
+ *   - result: unchanged,
+ *   - csv:    comma separated values, with a header whenever the keys change,
+ *   - json:   one object per line, numbers unquoted.
+ *  Other lines go to log in the csv and json format, so the output stays
+ *  machine readable. While discarding, RESULT lines are dropped. The
+ *  buffer replaces the buffer of the stream for its lifetime.
+ */
+class result_format_buf : public std::streambuf
+{
+  private:
+    std::ostream &m_stream;
+    std::streambuf *m_out;
+    std::streambuf *m_log;
+    std::string m_format;
+    std::string m_line;
+    std::string m_fields;
+    std::vector<std::string> m_header;
+    bool m_discard = false;
+
+    static bool is_number(const std::string &value)
+    {
+        if (value.empty())
+        {
+            return false;
+        }
+        char *end = nullptr;
+        std::strtod(value.c_str(), &end);
+        return *end == '\0' && value != "nan" && value != "inf" && value != "-inf";
+    }
+
+    static std::string csv_value(const std::string &value)
+    {
+        if (value.find_first_of(",\"") == std::string::npos)
+        {
+            return value;
+        }
+        std::string quoted = "\"";
+        for (char c : value)
+        {
+            quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+        }
+        return quoted + "\"";
+    }
+
+    static std::string json_string(const std::string &value)
+    {
+        std::string quoted = "\"";
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    void write(std::streambuf *buf, const std::string &s)
+    {
+        buf->sputn(s.data(), s.size());
+    }
+
+    void write_result(const std::string &line)
+    {
+        std::vector<std::pair<std::string, std::string>> fields;
+        std::istringstream in(m_fields + line.substr(6));
+        std::string field;
+        while (in >> field)
+        {
+            size_t eq = field.find('=');
+            if (eq == std::string::npos)
+            {
+                fields.emplace_back(field, "");
+            }
+            else
+            {
+                fields.emplace_back(field.substr(0, eq), field.substr(eq + 1));
+            }
+        }
+
+        std::string out;
+        if (m_format == "csv")
+        {
+            std::vector<std::string> header;
+            for (auto &f : fields)
+            {
+                header.push_back(f.first);
+            }
+            if (header != m_header)
+            {
+                for (size_t i = 0; i < header.size(); ++i)
+                {
+                    out += (i ? "," : "") + csv_value(header[i]);
+                }
+                out += "\n";
+                m_header = header;
+            }
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                out += (i ? "," : "") + csv_value(fields[i].second);
+            }
+        }
+        else if (m_format == "json")
+        {
+            out = "{";
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                out += (i ? "," : "") + json_string(fields[i].first) + ":";
+                out += is_number(fields[i].second) ? fields[i].second : json_string(fields[i].second);
+            }
+            out += "}";
+        }
+        else
+        {
+            out = "RESULT" + m_fields + line.substr(6);
+        }
+        write(m_out, out + "\n");
+    }
+
+    void write_line()
+    {
+        std::string line;
+        line.swap(m_line);
+        bool result = line.compare(0, 6, "RESULT") == 0 && (line.size() == 6 || line[6] == ' ');
+        if (!result)
+        {
+            write(m_format == "result" ? m_out : m_log, line + "\n");
+        }
+        else if (!m_discard)
+        {
+            write_result(line);
+        }
+    }
+
+  protected:
+    int overflow(int c) override
+    {
+        if (c == traits_type::eof())
+        {
+            return traits_type::not_eof(c);
+        }
+        if (c == '\n')
+        {
+            write_line();
+        }
+        else
+        {
+            m_line += static_cast<char>(c);
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        for (std::streamsize i = 0; i < n; ++i)
+        {
+            overflow(static_cast<unsigned char>(s[i]));
+        }
+        return n;
+    }
+
+    int sync() override
+    {
+        m_out->pubsync();
+        m_log->pubsync();
+        return 0;
+    }
+
+  public:
+    //! \param format result, csv or json.
+    result_format_buf(std::ostream &stream, std::streambuf *log, const std::string &format)
+        : m_stream(stream), m_out(stream.rdbuf()), m_log(log), m_format(format)
+    {
+        if (format != "result" && format != "csv" && format != "json")
+        {
+            throw std::invalid_argument("unknown output format '" + format + "', use result, csv or json");
+        }
+        m_stream.rdbuf(this);
+    }
+
+    ~result_format_buf()
+    {
+        m_stream.flush();
+        m_stream.rdbuf(m_out);
+        if (!m_line.empty())
+        {
+            write_line();
+        }
+        sync();
+    }
+
+    //! Fields added to every RESULT line, e.g. " Repetition=1".
+    void set_fields(const std::string &fields)
+    {
+        m_fields = fields;
+    }
+
+    void set_discard(bool discard)
+    {
+        m_discard = discard;
+    }
+};
+
+} // end namespace sdsl
+#endif
@@ -0,0 +1,153 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file concurrent_benchmark.hpp
+   \brief concurrent_benchmark.hpp contains helpers to run a query workload on several pinned threads.
+   \author Simon Gog
+*/
+#ifndef CONCURRENT_BENCHMARK
+#define CONCURRENT_BENCHMARK
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Timing of one thread of run_pinned_threads.
+/*! Aligned to a cache line, so the threads do not share the lines they write.
+ */
+struct alignas(64) thread_timing
+{
+    double seconds = 0;
+    uint64_t queries = 0;
+};
+
+//! Allocator honouring the alignment of T.
+/*! Before C++17 std::allocator only guarantees the alignment of
+ *  max_align_t, which is less than the cache line of thread_timing.
+ */
+template <class T>
+struct aligned_allocator
+{
+    typedef T value_type;
+
+    aligned_allocator() = default;
+
+    template <class U>
+    aligned_allocator(const aligned_allocator<U> &) {}
+
+    T *allocate(std::size_t n)
+    {
+        void *p = nullptr;
+        if (posix_memalign(&p, alignof(T), n * sizeof(T)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        free(p);
+    }
+
+    template <class U>
+    bool operator==(const aligned_allocator<U> &) const
+    {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const aligned_allocator<U> &) const
+    {
+        return false;
+    }
+};
+
+//! Timings of the threads of run_pinned_threads, one cache line each.
+typedef std::vector<thread_timing, aligned_allocator<thread_timing>> thread_timings;
+
+//! Pin the calling thread to cpu modulo the number of cpus.
+/*! \return false if the thread could not be pinned.
+ */
+inline bool pin_to_cpu(uint64_t cpu)
+{
+#ifdef __linux__
+    uint64_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % cpus, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+//! Run f(t) for t in [0, threads) on threads threads, thread t pinned to cpu t.
+/*! The threads are released together once all of them are pinned. f(t)
+ *  returns the number of queries it answered; its time is stored in
+ *  timings[t].
+ *  \return Wall clock seconds from the release to the end of the last thread.
+ */
+template <class t_func>
+double run_pinned_threads(uint64_t threads, thread_timings &timings, t_func f)
+{
+    timings.assign(threads, thread_timing());
+    std::atomic<uint64_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            pin_to_cpu(t);
+            ++ready;
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            auto start = std::chrono::steady_clock::now();
+            uint64_t queries = f(t);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            timings[t].seconds = elapsed.count();
+            timings[t].queries = queries;
+        });
+    }
+    while (ready.load() < threads)
+    {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+} // end namespace sdsl
+#endif
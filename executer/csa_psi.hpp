@@ -0,0 +1,293 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file csa_psi.hpp
+   \brief csa_psi.hpp contains a compressed suffix array on top of the psi vectors.
+   \author Simon Gog
+*/
+#ifndef CSA_PSI
+#define CSA_PSI
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/int_vector_buffer.hpp>
+#include <sdsl/rank_support.hpp>
+#include <sdsl/config.hpp>
+#include <sdsl/io.hpp>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! A compressed suffix array for byte alphabets built from a psi vector.
+/*! count uses backward search on psi: the suffixes starting with cP are the
+ *  positions j of the F range of c with psi[j] in the range of P. The F
+ *  range of c lies inside one bucket of the psi vector, so this is one
+ *  range_search on that bucket per pattern symbol.
+ *
+ *  locate walks psi, which maps SA[i] to SA[i]+1, until it reaches a
+ *  sampled suffix. Every suffix at a text position divisible by
+ *  t_sa_sample_dens is sampled, and so is the last suffix, so a walk takes
+ *  less than t_sa_sample_dens steps.
+ *
+ *  extract starts at the inverse suffix array sample in front of the text
+ *  position, walks psi to the position and then reads one symbol per psi
+ *  step off the C array.
+ *
+ *  \tparam t_psi_vector      sdsl_psi_vector<...> or rlcsa_psi_vector<...>.
+ *  \tparam t_sa_sample_dens  Text distance of the suffix array samples.
+ *  \tparam t_isa_sample_dens Text distance of the inverse suffix array samples.
+ */
+template <class t_psi_vector, uint32_t t_sa_sample_dens = 32, uint32_t t_isa_sample_dens = 64>
+class csa_psi
+{
+  public:
+    typedef int_vector<>::size_type size_type;
+    typedef t_psi_vector psi_type;
+
+  private:
+    size_type m_size = 0; // length of the text including the sentinel
+    t_psi_vector m_psi;
+    int_vector<64> m_C; // m_C[c] number of symbols smaller than c
+    int_vector<64> m_symbol_bucket; // bucket of the psi vector containing the F range of c
+    bit_vector m_sa_sample_marker;
+    rank_support_v5<> m_sa_sample_rank;
+    int_vector<> m_sa_samples;
+    int_vector<> m_isa_samples; // m_isa_samples[k] = ISA[k*t_isa_sample_dens]
+
+    //! Symbol of the F column at position j.
+    unsigned char first_symbol(size_type j) const
+    {
+        size_type lo = 0, hi = 256; // m_C[lo] <= j < m_C[hi]
+        while (hi - lo > 1)
+        {
+            size_type mid = (lo + hi) / 2;
+            if (m_C[mid] <= j)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+  public:
+    csa_psi() = default;
+    csa_psi(const csa_psi &) = delete;
+    csa_psi &operator=(const csa_psi &) = delete;
+
+    //! Constructor for psi and BWT stored in the cache under conf::KEY_PSI and conf::KEY_BWT.
+    /*! \param threads Number of threads encoding the psi buckets.
+     */
+    csa_psi(cache_config &config, size_type threads = 1)
+    {
+        int_vector<> psi;
+        load_from_cache(psi, conf::KEY_PSI, config);
+        m_size = psi.size();
+        {
+            t_psi_vector tmp(psi, threads);
+            m_psi.swap(tmp);
+        }
+
+        m_C = int_vector<64>(257, 0);
+        {
+            int_vector_buffer<8> bwt(cache_file_name(conf::KEY_BWT, config));
+            for (size_type i = 0; i < bwt.size(); ++i)
+            {
+                ++m_C[bwt[i] + 1];
+            }
+        }
+        for (size_type c = 1; c < m_C.size(); ++c)
+        {
+            m_C[c] += m_C[c - 1];
+        }
+        m_symbol_bucket = int_vector<64>(256, 0);
+        for (size_type c = 0; c < m_symbol_bucket.size(); ++c)
+        {
+            if (m_C[c] < m_C[c + 1])
+            {
+                m_symbol_bucket[c] = m_psi.bucket(m_C[c]);
+            }
+        }
+
+        // psi[0] is the suffix at text position 0, psi moves one text position on.
+        m_sa_sample_marker = bit_vector(m_size, 0);
+        for (size_type i = psi[0], t = 0; t < m_size; i = psi[i], ++t)
+        {
+            if (t % t_sa_sample_dens == 0 || t + 1 == m_size)
+            {
+                m_sa_sample_marker[i] = 1;
+            }
+        }
+        m_sa_sample_rank = rank_support_v5<>(&m_sa_sample_marker);
+        m_sa_samples = int_vector<>(m_sa_sample_rank(m_size), 0, bits::hi(m_size) + 1);
+        m_isa_samples = int_vector<>((m_size + t_isa_sample_dens - 1) / t_isa_sample_dens, 0, bits::hi(m_size) + 1);
+        for (size_type i = psi[0], t = 0; t < m_size; i = psi[i], ++t)
+        {
+            if (m_sa_sample_marker[i])
+            {
+                m_sa_samples[m_sa_sample_rank(i)] = t;
+            }
+            if (t % t_isa_sample_dens == 0)
+            {
+                m_isa_samples[t / t_isa_sample_dens] = i;
+            }
+        }
+    }
+
+    //! Length of the text including the sentinel.
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    //! The psi vector.
+    const t_psi_vector &psi() const
+    {
+        return m_psi;
+    }
+
+    //! Backward search for the pattern [begin, end).
+    /*! \param sp First suffix array position prefixed by the pattern.
+     *  \param ep Last suffix array position prefixed by the pattern.
+     *  \return The number of occurrences, sp and ep are undefined if it is 0.
+     */
+    template <class t_pat_iter>
+    size_type backward_search(t_pat_iter begin, t_pat_iter end, size_type &sp, size_type &ep) const
+    {
+        sp = 0;
+        ep = m_size - 1;
+        for (t_pat_iter it = end; it != begin;)
+        {
+            --it;
+            unsigned char c = *it;
+            size_type lo = m_C[c], hi = m_C[c + 1];
+            if (lo == hi)
+            {
+                return 0;
+            }
+            if (it + 1 != end)
+            {
+                auto range = m_psi.range_search(m_symbol_bucket[c], sp, ep);
+                lo = std::max(lo, range.first);
+                hi = std::min(hi, range.second);
+                if (lo >= hi)
+                {
+                    return 0;
+                }
+            }
+            sp = lo;
+            ep = hi - 1;
+        }
+        return ep - sp + 1;
+    }
+
+    //! Number of occurrences of pattern.
+    size_type count(const std::string &pattern) const
+    {
+        size_type sp, ep;
+        return backward_search(pattern.begin(), pattern.end(), sp, ep);
+    }
+
+    //! Suffix array value at position i.
+    size_type sa(size_type i) const
+    {
+        size_type steps = 0;
+        while (!m_sa_sample_marker[i])
+        {
+            i = m_psi[i];
+            ++steps;
+        }
+        return m_sa_samples[m_sa_sample_rank(i)] - steps;
+    }
+
+    //! Inverse suffix array value at text position t.
+    size_type isa(size_type t) const
+    {
+        size_type i = m_isa_samples[t / t_isa_sample_dens];
+        for (size_type k = t - t % t_isa_sample_dens; k < t; ++k)
+        {
+            i = m_psi[i];
+        }
+        return i;
+    }
+
+    //! The text T[t..t+len-1], cut at the end of the text.
+    std::string extract(size_type t, size_type len) const
+    {
+        std::string s;
+        len = std::min(len, m_size - t);
+        s.reserve(len);
+        for (size_type k = 0, i = isa(t); k < len; ++k, i = m_psi[i])
+        {
+            s.push_back(first_symbol(i));
+        }
+        return s;
+    }
+
+    //! Text positions of all occurrences of pattern, in suffix array order.
+    std::vector<size_type> locate(const std::string &pattern) const
+    {
+        std::vector<size_type> occ;
+        size_type sp, ep;
+        if (backward_search(pattern.begin(), pattern.end(), sp, ep) > 0)
+        {
+            occ.reserve(ep - sp + 1);
+            for (size_type i = sp; i <= ep; ++i)
+            {
+                occ.push_back(sa(i));
+            }
+        }
+        return occ;
+    }
+
+    size_type serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+    {
+        structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
+        size_type written_bytes = 0;
+        written_bytes += write_member(m_size, out, child, "size");
+        written_bytes += m_psi.serialize(out, child, "psi");
+        written_bytes += m_C.serialize(out, child, "C");
+        written_bytes += m_symbol_bucket.serialize(out, child, "symbol bucket");
+        written_bytes += m_sa_sample_marker.serialize(out, child, "sa sample marker");
+        written_bytes += m_sa_sample_rank.serialize(out, child, "sa sample rank");
+        written_bytes += m_sa_samples.serialize(out, child, "sa samples");
+        written_bytes += m_isa_samples.serialize(out, child, "isa samples");
+        structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream &in)
+    {
+        read_member(m_size, in);
+        m_psi.load(in);
+        m_C.load(in);
+        m_symbol_bucket.load(in);
+        m_sa_sample_marker.load(in);
+        m_sa_sample_rank.load(in, &m_sa_sample_marker);
+        m_sa_samples.load(in);
+        m_isa_samples.load(in);
+    }
+};
+
+} // end namespace sdsl
+#endif
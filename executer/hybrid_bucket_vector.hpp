@@ -0,0 +1,455 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file hybrid_bucket_vector.hpp
+   \brief hybrid_bucket_vector.hpp contains the sdsl::hybrid_bucket_vector class, a psi bucket choosing its own encoding.
+   \author Simon Gog
+*/
+#ifndef HYBRID_BUCKET_VECTOR
+#define HYBRID_BUCKET_VECTOR
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/coder.hpp>
+#include <sdsl/enc_vector.hpp>
+#include <sdsl/rl_inc_vector.hpp>
+#include <sdsl/dac_vector.hpp>
+#include <sdsl/sd_vector.hpp>
+#include <sdsl/util.hpp>
+#include <sdsl/io.hpp>
+
+#include "sdsl_psi_vector.hpp"
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! The coder of the gaps of an enc_vector, Elias-delta for other vectors.
+template <class t_vector>
+struct enc_vector_coder
+{
+    typedef coder::elias_delta type;
+};
+
+template <class t_coder, uint32_t t_dens, uint8_t t_width>
+struct enc_vector_coder<enc_vector<t_coder, t_dens, t_width>>
+{
+    typedef t_coder type;
+};
+
+//! An increasing bucket of psi stored run-length, delta or plain encoded.
+/*! The constructor scans the bucket once, counting its runs (maximal
+ *  stretches with v[i+1] = v[i]+1) and estimating the size of every
+ *  encoding in bits with a simple model:
+ *   - plain:      n times the width of the last value,
+ *   - run-length: Elias-gamma codes of the gap before every run and of its
+ *                 length,
+ *   - delta:      the codes of t_enc_vector's coder for all gaps plus two
+ *                 samples per block.
+ *  The model ignores the DAC levels, the sd_vector and the samples of
+ *  t_rl_vector and the headers, so it is calibrated: every encoding is
+ *  built on the first sample_size elements and the model estimate of the
+ *  bucket is scaled by the ratio of the real size_in_bytes to the model on
+ *  that prefix. Buckets of at most sample_size elements are thus measured
+ *  exactly, see estimate_bytes().
+ *
+ *  It then uses the chosen encoding: among the encodings at most
+ *  t_slack_percent larger than the smallest, the one with the lowest
+ *  estimated access cost. The costs are in decoding steps:
+ *   - plain:      1,
+ *   - run-length: 2 + log2(runs), locating the run and the offset in it,
+ *   - delta:      1 + half a sample block of t_enc_vector.
+ *  t_slack_percent = 0 picks the smallest encoding, a large value the
+ *  fastest one. Accesses dispatch on a one byte tag, which is the same for
+ *  every position of the bucket, so the branch is well predicted.
+ *
+ *  Used as the bucket type of sdsl_psi_vector, e.g.
+ *  sdsl_psi_vector<hybrid_bucket_vector<>>.
+ *
+ *  \tparam t_rl_vector     Run-length encoded vector for buckets with long runs.
+ *  \tparam t_enc_vector    Delta encoded vector for buckets with small gaps.
+ *  \tparam t_slack_percent Space in percent that may be traded for a faster encoding.
+ */
+template <class t_rl_vector = rl_inc_vector<dac_vector_dp<>, sd_vector<>, 8>,
+          class t_enc_vector = enc_vector<>,
+          uint32_t t_slack_percent = 10>
+class hybrid_bucket_vector
+{
+  public:
+    typedef uint64_t value_type;
+    typedef int_vector<>::size_type size_type;
+
+    enum kind_type : uint8_t
+    {
+        plain = 0,
+        run_length = 1,
+        delta = 2
+    };
+
+    //! Elements of the prefix on which the size model is calibrated.
+    static const size_type sample_size = 1 << 16;
+
+  private:
+    uint8_t m_kind = plain;
+    int_vector<> m_plain;
+    t_rl_vector m_rl;
+    t_enc_vector m_enc;
+
+    template <class Container>
+    void build(const Container &c, kind_type kind)
+    {
+        m_kind = kind;
+        switch (kind)
+        {
+        case run_length:
+        {
+            t_rl_vector tmp(c);
+            m_rl.swap(tmp);
+            break;
+        }
+        case delta:
+        {
+            t_enc_vector tmp(c);
+            m_enc.swap(tmp);
+            break;
+        }
+        default:
+        {
+            int_vector<> tmp(c.size(), 0, 64);
+            for (size_type i = 0; i < c.size(); ++i)
+            {
+                tmp[i] = c[i];
+            }
+            util::bit_compress(tmp);
+            m_plain.swap(tmp);
+        }
+        }
+    }
+
+    //! Model sizes in bits of the three encodings, accumulated value by value.
+    template <class t_coder>
+    struct size_model
+    {
+        size_type n = 0;
+        size_type runs = 0;
+        size_type length = 0; // of the run in progress
+        uint64_t last = 0;
+        uint64_t gamma_bits = 0;
+        uint64_t coder_bits = 0;
+
+        void add(uint64_t value)
+        {
+            uint64_t gap = n == 0 ? value + 1 : value - last;
+            coder_bits += t_coder::encoding_length(gap);
+            if (n > 0 && gap == 1)
+            {
+                ++length;
+            }
+            else
+            {
+                if (length > 0)
+                {
+                    gamma_bits += coder::elias_gamma::encoding_length(length);
+                }
+                gamma_bits += coder::elias_gamma::encoding_length(gap);
+                length = 1;
+                ++runs;
+            }
+            last = value;
+            ++n;
+        }
+
+        //! Model bits of every encoding, indexed by kind_type.
+        void bits(double out[3]) const
+        {
+            uint64_t width = n > 0 ? sdsl::bits::hi(last) + 1 : 1;
+            uint64_t block_size = psi_block_size(t_enc_vector());
+            out[plain] = n * width;
+            out[run_length] = gamma_bits + (length > 0 ? coder::elias_gamma::encoding_length(length) : 0);
+            out[delta] = coder_bits + 2 * width * (n / block_size + 1);
+        }
+    };
+
+    //! Estimate the bytes of every encoding of c, see the class description.
+    /*! If c is not longer than sample_size, the candidates built are moved
+     *  to candidates, if given.
+     *  \param runs Receives the number of runs of c.
+     *  \return Whether the estimates are the real sizes.
+     */
+    template <class Container>
+    static bool calibrate(const Container &c, uint64_t bytes[3], size_type &runs, hybrid_bucket_vector *candidates)
+    {
+        size_type n = c.size();
+        size_type m = std::min(n, sample_size);
+        size_model<typename enc_vector_coder<t_enc_vector>::type> whole, prefix;
+        int_vector<> head(m, 0, n > 0 ? bits::hi(c[n - 1]) + 1 : 1);
+        for (size_type i = 0; i < n; ++i)
+        {
+            whole.add(c[i]);
+            if (i < m)
+            {
+                head[i] = c[i];
+            }
+            if (i + 1 == m)
+            {
+                prefix = whole;
+            }
+        }
+        double whole_bits[3], prefix_bits[3];
+        whole.bits(whole_bits);
+        prefix.bits(prefix_bits);
+        for (uint8_t k = plain; k <= delta; ++k)
+        {
+            hybrid_bucket_vector candidate;
+            candidate.build(head, static_cast<kind_type>(k));
+            uint64_t real = size_in_bytes(candidate);
+            bytes[k] = m == n ? real : (uint64_t)(whole_bits[k] * real / std::max(prefix_bits[k], 1.0));
+            if (candidates != nullptr && m == n)
+            {
+                candidates[k].swap(candidate);
+            }
+        }
+        runs = whole.runs;
+        return m == n;
+    }
+
+  public:
+    hybrid_bucket_vector() = default;
+
+    //! Encode the increasing sequence c with the encoding chosen as described above.
+    template <class Container>
+    hybrid_bucket_vector(const Container &c)
+    {
+        uint64_t bytes[3];
+        size_type runs = 0;
+        hybrid_bucket_vector candidates[3];
+        bool exact = calibrate(c, bytes, runs, candidates);
+
+        double cost[3];
+        uint64_t block_size = psi_block_size(t_enc_vector());
+        cost[plain] = 1;
+        cost[run_length] = 2 + bits::hi(runs + 1);
+        cost[delta] = 1 + block_size / 2.0;
+
+        uint64_t smallest = *std::min_element(bytes, bytes + 3);
+        uint8_t best = plain;
+        for (uint8_t k = plain; k <= delta; ++k)
+        {
+            if (bytes[k] * 100 > smallest * (100 + t_slack_percent))
+            {
+                continue;
+            }
+            if (bytes[best] * 100 > smallest * (100 + t_slack_percent) || cost[k] < cost[best] ||
+                (cost[k] == cost[best] && bytes[k] < bytes[best]))
+            {
+                best = k;
+            }
+        }
+        if (exact)
+        {
+            swap(candidates[best]);
+        }
+        else
+        {
+            build(c, static_cast<kind_type>(best));
+        }
+    }
+
+    //! Estimated size_in_bytes of every encoding of c, indexed by kind_type.
+    /*! Exact for buckets of at most sample_size elements.
+     */
+    template <class Container>
+    static void estimate_bytes(const Container &c, uint64_t bytes[3])
+    {
+        size_type runs = 0;
+        calibrate(c, bytes, runs, nullptr);
+    }
+
+    //! Encode c with the given encoding.
+    template <class Container>
+    hybrid_bucket_vector(const Container &c, kind_type kind)
+    {
+        build(c, kind);
+    }
+
+    //! The encoding of the bucket.
+    kind_type kind() const
+    {
+        return static_cast<kind_type>(m_kind);
+    }
+
+    const int_vector<> &plain_vector() const
+    {
+        return m_plain;
+    }
+
+    const t_rl_vector &run_length_vector() const
+    {
+        return m_rl;
+    }
+
+    const t_enc_vector &delta_vector() const
+    {
+        return m_enc;
+    }
+
+    size_type size() const
+    {
+        switch (m_kind)
+        {
+        case run_length:
+            return m_rl.size();
+        case delta:
+            return m_enc.size();
+        default:
+            return m_plain.size();
+        }
+    }
+
+    value_type operator[](size_type i) const
+    {
+        switch (m_kind)
+        {
+        case run_length:
+            return m_rl[i];
+        case delta:
+            return m_enc[i];
+        default:
+            return m_plain[i];
+        }
+    }
+
+    void swap(hybrid_bucket_vector &v)
+    {
+        if (this != &v)
+        {
+            std::swap(m_kind, v.m_kind);
+            m_plain.swap(v.m_plain);
+            m_rl.swap(v.m_rl);
+            m_enc.swap(v.m_enc);
+        }
+    }
+
+    //! Serialize the kind and the encoding in use.
+    size_type serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const
+    {
+        structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
+        size_type written_bytes = write_member(m_kind, out, child, "kind");
+        switch (m_kind)
+        {
+        case run_length:
+            written_bytes += m_rl.serialize(out, child, "run_length");
+            break;
+        case delta:
+            written_bytes += m_enc.serialize(out, child, "delta");
+            break;
+        default:
+            written_bytes += m_plain.serialize(out, child, "plain");
+        }
+        structure_tree::add_size(child, written_bytes);
+        return written_bytes;
+    }
+
+    void load(std::istream &in)
+    {
+        hybrid_bucket_vector tmp;
+        swap(tmp);
+        read_member(m_kind, in);
+        switch (m_kind)
+        {
+        case run_length:
+            m_rl.load(in);
+            break;
+        case delta:
+            m_enc.load(in);
+            break;
+        default:
+            m_plain.load(in);
+        }
+    }
+};
+
+template <class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent>
+const typename hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent>::size_type
+    hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent>::sample_size;
+
+//! The block size of the encoding in use.
+template <class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent>
+inline uint64_t psi_block_size(const hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> &v)
+{
+    typedef hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> hybrid_type;
+    switch (v.kind())
+    {
+    case hybrid_type::run_length:
+        return psi_block_size(v.run_length_vector());
+    case hybrid_type::delta:
+        return psi_block_size(v.delta_vector());
+    default:
+        return psi_block_size(v.plain_vector());
+    }
+}
+
+//! Whether the encoding in use decodes a block in one pass.
+template <class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent>
+inline bool psi_decodes_blocks(const hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> &v)
+{
+    typedef hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> hybrid_type;
+    switch (v.kind())
+    {
+    case hybrid_type::run_length:
+        return psi_decodes_blocks(v.run_length_vector());
+    case hybrid_type::delta:
+        return psi_decodes_blocks(v.delta_vector());
+    default:
+        return psi_decodes_blocks(v.plain_vector());
+    }
+}
+
+//! Decode a block with the decoder of the encoding in use.
+template <class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent>
+inline void psi_decode_block(const hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> &v, uint64_t i, uint64_t n, uint64_t *buf)
+{
+    typedef hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> hybrid_type;
+    switch (v.kind())
+    {
+    case hybrid_type::run_length:
+        psi_decode_block(v.run_length_vector(), i, n, buf);
+        break;
+    case hybrid_type::delta:
+        psi_decode_block(v.delta_vector(), i, n, buf);
+        break;
+    default:
+        psi_decode_block(v.plain_vector(), i, n, buf);
+    }
+}
+
+//! Search with the lower bound of the encoding in use.
+template <class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent>
+inline uint64_t psi_lower_bound(const hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> &v, uint64_t x)
+{
+    typedef hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> hybrid_type;
+    switch (v.kind())
+    {
+    case hybrid_type::run_length:
+        return psi_lower_bound(v.run_length_vector(), x);
+    case hybrid_type::delta:
+        return psi_lower_bound(v.delta_vector(), x);
+    default:
+        return psi_lower_bound(v.plain_vector(), x);
+    }
+}
+
+} // end namespace sdsl
+#endif
@@ -0,0 +1,198 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file latency_histogram.hpp
+   \brief latency_histogram.hpp contains a cycle counter and a log-bucketed latency histogram.
+   \author Simon Gog
+*/
+#ifndef LATENCY_HISTOGRAM
+#define LATENCY_HISTOGRAM
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <sdsl/bits.hpp>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Low overhead timer for single queries.
+/*! Uses the time stamp counter, fenced so the query can not move across
+ *  the reads, on x86 and steady_clock nanoseconds elsewhere. The length
+ *  of a tick and the cost of a pair of reads are calibrated once.
+ */
+class cycle_timer
+{
+  private:
+    struct calibration
+    {
+        double ns_per_tick = 1;
+        uint64_t overhead = 0;
+
+        calibration()
+        {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t start_ticks = cycle_timer::now();
+            std::chrono::duration<double, std::nano> elapsed;
+            do
+            {
+                elapsed = std::chrono::steady_clock::now() - start;
+            } while (elapsed.count() < 2e7);
+            ns_per_tick = elapsed.count() / std::max((uint64_t)1, cycle_timer::now() - start_ticks);
+
+            overhead = UINT64_MAX;
+            for (int i = 0; i < 10000; ++i)
+            {
+                uint64_t t = cycle_timer::now();
+                overhead = std::min(overhead, cycle_timer::now() - t);
+            }
+        }
+    };
+
+    static const calibration &calibrated()
+    {
+        static calibration c;
+        return c;
+    }
+
+  public:
+    //! Current tick.
+    static inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    //! Ticks of a query that started at tick start, without the timer overhead.
+    static inline uint64_t elapsed(uint64_t start)
+    {
+        uint64_t ticks = now() - start;
+        uint64_t overhead = calibrated().overhead;
+        return ticks > overhead ? ticks - overhead : 0;
+    }
+
+    //! Length of a tick in nanoseconds.
+    static double ns_per_tick()
+    {
+        return calibrated().ns_per_tick;
+    }
+
+    //! Ticks of two back-to-back reads of the timer.
+    static uint64_t overhead()
+    {
+        return calibrated().overhead;
+    }
+};
+
+//! Histogram of latencies in ticks with logarithmic buckets.
+/*! Values below 2^t_sub_bits have a bucket each. Above, every power of two
+ *  is split into 2^t_sub_bits buckets, so a percentile is off by less than
+ *  2^-t_sub_bits relative. The maximum is kept exactly.
+ */
+template <uint8_t t_sub_bits = 4>
+class latency_histogram
+{
+  private:
+    static const uint64_t sub_buckets = 1ULL << t_sub_bits;
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+
+    static uint64_t bucket(uint64_t v)
+    {
+        if (v < sub_buckets)
+        {
+            return v;
+        }
+        uint64_t e = bits::hi(v);
+        return (e - t_sub_bits + 1) * sub_buckets + ((v >> (e - t_sub_bits)) & (sub_buckets - 1));
+    }
+
+    //! Largest value of bucket b.
+    static uint64_t bucket_max(uint64_t b)
+    {
+        if (b < sub_buckets)
+        {
+            return b;
+        }
+        uint64_t e = b / sub_buckets + t_sub_bits - 1;
+        uint64_t lo = (1ULL << e) | ((b % sub_buckets) << (e - t_sub_bits));
+        return lo + (1ULL << (e - t_sub_bits)) - 1;
+    }
+
+  public:
+    latency_histogram() : m_counts((65 - t_sub_bits) * sub_buckets, 0) {}
+
+    //! Add a latency of ticks.
+    void add(uint64_t ticks)
+    {
+        ++m_counts[bucket(ticks)];
+        ++m_count;
+        m_max = std::max(m_max, ticks);
+    }
+
+    //! Number of latencies.
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+    //! Latency in ticks below which a fraction p of the latencies lies, p in (0, 1].
+    uint64_t percentile(double p) const
+    {
+        uint64_t rank = std::max((uint64_t)1, (uint64_t)(p * m_count + 0.5));
+        uint64_t seen = 0;
+        for (uint64_t b = 0; b < m_counts.size(); ++b)
+        {
+            seen += m_counts[b];
+            if (seen >= rank)
+            {
+                return std::min(bucket_max(b), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    //! Largest latency in ticks.
+    uint64_t max() const
+    {
+        return m_max;
+    }
+
+    void clear()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+        m_max = 0;
+    }
+};
+
+} // end namespace sdsl
+#endif
@@ -0,0 +1,77 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file memory_usage.hpp
+   \brief memory_usage.hpp contains helpers to measure the memory usage of the experiments.
+   \author Simon Gog
+*/
+#ifndef MEMORY_USAGE
+#define MEMORY_USAGE
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <sys/resource.h>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Peak resident set size of the process in bytes.
+/*! Read from VmHWM in /proc/self/status, the counter reset_peak_rss resets.
+ *  getrusage's ru_maxrss is no substitute: the kernel folds VmHWM into it
+ *  whenever a thread exits and never lowers it, so after the first threaded
+ *  phase it holds the peak of that phase. It is only the fallback where
+ *  /proc is not available.
+ */
+inline uint64_t peak_rss_bytes()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key)
+    {
+        if (key == "VmHWM:")
+        {
+            uint64_t kib = 0;
+            status >> kib;
+            return kib * 1024;
+        }
+        status.ignore(4096, '\n');
+    }
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+//! Reset the peak resident set size to the current resident set size.
+/*! Writing 5 to /proc/self/clear_refs is supported since Linux 4.0. Where
+ *  it is not, the peak keeps covering the whole run of the process.
+ *  \return true if the peak was reset.
+ */
+inline bool reset_peak_rss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    return static_cast<bool>(clear_refs.flush());
+}
+
+} // end namespace sdsl
+#endif
@@ -0,0 +1,369 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file parallel_construction.hpp
+   \brief parallel_construction.hpp contains helpers for the multi-threaded construction of the psi vectors.
+   \author Simon Gog
+*/
+#ifndef PARALLEL_CONSTRUCTION
+#define PARALLEL_CONSTRUCTION
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Call f(t, begin, end) for the chunks t of [0, n), one thread per chunk.
+/*! There are at most threads chunks, each a multiple of 64 elements long
+ *  except the last, so threads writing bit vectors per chunk never share a
+ *  word. The chunks are in order: chunk t+1 starts where chunk t ends.
+ */
+template <class t_func>
+void parallel_for_chunks(uint64_t n, uint64_t threads, t_func f)
+{
+    threads = std::max((uint64_t)1, std::min(threads, (n + 63) / 64));
+    uint64_t chunk = (((n + threads - 1) / threads + 63) / 64) * 64;
+    if (threads == 1)
+    {
+        f((uint64_t)0, (uint64_t)0, n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(f, t, std::min(n, t * chunk), std::min(n, (t + 1) * chunk));
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+//! Mark the bucket starts of c in marker.
+/*! A bucket starts at 0 and wherever c[i] < c[i-1]; marker[c.size()] is set
+ *  as well. The scan is split by parallel_for_chunks, so every thread
+ *  writes its own words of marker.
+ *  \param c       A container of unsigned integers.
+ *  \param marker  Bit vector of length c.size()+1, initialized to 0.
+ *  \param threads Number of threads.
+ *  \return The number of buckets.
+ */
+template <class Container>
+uint64_t mark_alphabet_boundaries(const Container &c, bit_vector &marker, uint64_t threads = 1)
+{
+    uint64_t n = c.size();
+    marker[0] = 1;
+    marker[n] = 1;
+    std::vector<uint64_t> count(std::max((uint64_t)1, threads), 0);
+    parallel_for_chunks(n, threads, [&](uint64_t t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = std::max((uint64_t)1, begin); i < end; ++i)
+        {
+            if (c[i] < c[i - 1])
+            {
+                marker[i] = 1;
+                count[t]++;
+            }
+        }
+    });
+    return 1 + std::accumulate(count.begin(), count.end(), (uint64_t)0);
+}
+
+//! Call f(i) for every bucket i on threads threads.
+/*! Buckets are handed out longest first from a shared counter, which keeps
+ *  the threads busy even if a few buckets dominate the input. f must only
+ *  write state owned by bucket i, then the result does not depend on the
+ *  number of threads.
+ */
+template <class t_boundaries, class t_func>
+void parallel_for_buckets(const t_boundaries &boundaries, uint64_t buckets, uint64_t threads, t_func f)
+{
+    threads = std::max((uint64_t)1, std::min(threads, buckets));
+    if (threads == 1)
+    {
+        for (uint64_t i = 0; i < buckets; ++i)
+        {
+            f(i);
+        }
+        return;
+    }
+    std::vector<uint64_t> order(buckets);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> length(buckets);
+    for (uint64_t i = 0; i < buckets; ++i)
+    {
+        length[i] = boundaries.start(i + 1) - boundaries.start(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&length](uint64_t a, uint64_t b) { return length[a] > length[b]; });
+
+    std::atomic<uint64_t> next(0);
+    auto work = [&]() {
+        for (uint64_t k = next++; k < buckets; k = next++)
+        {
+            f(order[k]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(work);
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+//! Call f(t, i) for every i in [0, count) on threads threads.
+/*! The items are handed out from a shared counter, t is the thread that
+ *  runs item i. With one thread f runs inline.
+ */
+template <class t_func>
+void parallel_for_items(uint64_t count, uint64_t threads, t_func f)
+{
+    threads = std::max((uint64_t)1, std::min(threads, count));
+    if (threads == 1)
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            f((uint64_t)0, i);
+        }
+        return;
+    }
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            for (uint64_t i = next++; i < count; i = next++)
+            {
+                f(t, i);
+            }
+        });
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+}
+
+//! Sort [first, last) by comp on threads threads.
+/*! The chunks of parallel_for_chunks are sorted by std::sort, then the
+ *  runs are merged pairwise, one thread per pair, in log(threads) rounds
+ *  that alternate between [first, last) and buffer.
+ *  \param buffer Space for last - first elements.
+ */
+template <class t_value, class t_comp>
+void parallel_sort(t_value *first, t_value *last, t_value *buffer, t_comp comp, uint64_t threads)
+{
+    uint64_t n = last - first;
+    if (threads <= 1)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+    // bounds[r] is the start of run r; chunks left out by parallel_for_chunks are empty.
+    std::vector<uint64_t> bounds(threads + 1, n);
+    bounds[0] = 0;
+    parallel_for_chunks(n, threads, [&](uint64_t t, uint64_t begin, uint64_t end) {
+        std::sort(first + begin, first + end, comp);
+        bounds[t + 1] = end;
+    });
+    t_value *src = first, *dst = buffer;
+    while (bounds.size() > 2)
+    {
+        std::vector<uint64_t> merged;
+        std::vector<std::thread> workers;
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2)
+        {
+            uint64_t begin = bounds[r], mid = bounds[r + 1];
+            uint64_t end = r + 2 < bounds.size() ? bounds[r + 2] : mid;
+            merged.push_back(begin);
+            workers.emplace_back([=]() { std::merge(src + begin, src + mid, src + mid, src + end, dst + begin, comp); });
+        }
+        merged.push_back(n);
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+        bounds.swap(merged);
+        std::swap(src, dst);
+    }
+    if (src != first)
+    {
+        parallel_for_chunks(n, threads, [&](uint64_t, uint64_t begin, uint64_t end) {
+            std::copy(src + begin, src + end, first + begin);
+        });
+    }
+}
+
+//! Sort the suffixes of text into sa on threads threads.
+/*! Prefix doubling: the suffixes are sorted by their first 8 symbols, then
+ *  every round sorts each group of suffixes with equal prefixes of length
+ *  h by the group of the suffix h symbols later, which doubles h. Groups
+ *  of more than n/threads suffixes are sorted by parallel_sort, the others
+ *  are handed out to the threads; a group of one suffix is final. A highly
+ *  repetitive text needs log of its longest repeat rounds over most of its
+ *  suffixes, so divsufsort in one thread may still win there. Besides text
+ *  and sa 3n words are used. sa must have the length of text.
+ */
+inline void parallel_suffix_sort(const int_vector<8> &text, int_vector<> &sa, uint64_t threads)
+{
+    typedef std::pair<uint64_t, uint64_t> group_type;
+    uint64_t n = text.size();
+    threads = std::max((uint64_t)1, threads);
+    // rank[i] is the first position in order of the group of suffix i, key[k]
+    // the sort key of order[k] in the current round. Before the first round
+    // rank[i] holds the first 8 symbols of suffix i.
+    std::vector<uint64_t> rank(n), order(n), key(n);
+    parallel_for_chunks(n, threads, [&](uint64_t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            uint64_t prefix = 0;
+            for (uint64_t k = i; k < i + 8; ++k)
+            {
+                prefix = (prefix << 8) | (k < n ? text[k] : 0);
+            }
+            rank[i] = prefix;
+            order[i] = i;
+        }
+    });
+
+    std::vector<group_type> groups(1, group_type(0, n));
+    for (uint64_t h = 0; !groups.empty(); h = std::max((uint64_t)8, 2 * h))
+    {
+        // A suffix that ends within h symbols is a prefix of the others in its
+        // group, and the shorter it is the smaller.
+        auto sort_key = [&rank, h, n](uint64_t x) {
+            return h == 0 ? rank[x] : (x + h < n ? n + 1 + rank[x + h] : n - x);
+        };
+        auto sort_group = [&](const group_type &g, uint64_t group_threads) {
+            parallel_sort(order.data() + g.first, order.data() + g.second, key.data() + g.first,
+                          [&sort_key](uint64_t a, uint64_t b) { return sort_key(a) < sort_key(b); }, group_threads);
+            parallel_for_chunks(g.second - g.first, group_threads, [&](uint64_t, uint64_t begin, uint64_t end) {
+                for (uint64_t k = g.first + begin; k < g.first + end; ++k)
+                {
+                    key[k] = sort_key(order[k]);
+                }
+            });
+        };
+        // Rank the suffixes of the sorted group g and append its new groups
+        // of more than one suffix to next.
+        auto rank_group = [&](const group_type &g, uint64_t group_threads, std::vector<group_type> &next) {
+            auto is_head = [&](uint64_t k) { return k == g.first || key[k] != key[k - 1]; };
+            auto is_last = [&](uint64_t k) { return k + 1 == g.second || key[k + 1] != key[k]; };
+            auto rank_range = [&](uint64_t begin, uint64_t end, uint64_t head, std::vector<group_type> &found) {
+                for (uint64_t k = begin; k < end; ++k)
+                {
+                    if (is_head(k))
+                    {
+                        head = k;
+                    }
+                    rank[order[k]] = head;
+                    if (is_last(k) && head < k)
+                    {
+                        found.emplace_back(head, k + 1);
+                    }
+                }
+            };
+            if (group_threads == 1)
+            {
+                rank_range(g.first, g.second, g.first, next);
+                return;
+            }
+            // A chunk continues the last group started in an earlier chunk.
+            std::vector<uint64_t> last_head(group_threads, g.second), carry(group_threads, g.first);
+            parallel_for_chunks(g.second - g.first, group_threads, [&](uint64_t t, uint64_t begin, uint64_t end) {
+                for (uint64_t k = g.first + end; k-- > g.first + begin;)
+                {
+                    if (is_head(k))
+                    {
+                        last_head[t] = k;
+                        break;
+                    }
+                }
+            });
+            for (uint64_t t = 1; t < group_threads; ++t)
+            {
+                carry[t] = last_head[t - 1] != g.second ? last_head[t - 1] : carry[t - 1];
+            }
+            std::vector<std::vector<group_type>> found(group_threads);
+            parallel_for_chunks(g.second - g.first, group_threads, [&](uint64_t t, uint64_t begin, uint64_t end) {
+                rank_range(g.first + begin, g.first + end, carry[t], found[t]);
+            });
+            for (auto &f : found)
+            {
+                next.insert(next.end(), f.begin(), f.end());
+            }
+        };
+
+        std::vector<group_type> large, small;
+        for (auto &g : groups)
+        {
+            (g.second - g.first > n / threads ? large : small).push_back(g);
+        }
+        // Every key is read before any rank of this round is written.
+        for (auto &g : large)
+        {
+            sort_group(g, threads);
+        }
+        parallel_for_items(small.size(), threads, [&](uint64_t, uint64_t i) { sort_group(small[i], 1); });
+        std::vector<std::vector<group_type>> next(threads);
+        for (auto &g : large)
+        {
+            rank_group(g, threads, next[0]);
+        }
+        parallel_for_items(small.size(), threads, [&](uint64_t t, uint64_t i) { rank_group(small[i], 1, next[t]); });
+        groups.clear();
+        for (auto &v : next)
+        {
+            groups.insert(groups.end(), v.begin(), v.end());
+        }
+    }
+
+    parallel_for_chunks(n, threads, [&](uint64_t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            sa[i] = order[i];
+        }
+    });
+}
+
+//! Fill bwt[i] = text[sa[i]-1], or the last symbol of text where sa[i] = 0.
+/*! Every thread reads text at random and writes its chunk of bwt. bwt must
+ *  have the length of text.
+ */
+inline void bwt_from_sa(const int_vector<8> &text, const int_vector<> &sa, int_vector<8> &bwt, uint64_t threads)
+{
+    uint64_t n = text.size();
+    parallel_for_chunks(n, threads, [&](uint64_t, uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            uint64_t p = sa[i];
+            bwt[i] = text[p > 0 ? p - 1 : n - 1];
+        }
+    });
+}
+
+} // end namespace sdsl
+#endif
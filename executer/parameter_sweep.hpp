@@ -0,0 +1,213 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file parameter_sweep.hpp
+   \brief parameter_sweep.hpp expands the cartesian product of template parameter lists at compile time.
+   \author Simon Gog
+*/
+#ifndef PARAMETER_SWEEP
+#define PARAMETER_SWEEP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include <sdsl/coder.hpp>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! A list of types, e.g. the values of one template parameter.
+template <class... t_types>
+struct type_list
+{
+};
+
+//! A list of unsigned template arguments, as types.
+template <uint32_t... t_values>
+using uint_list = type_list<std::integral_constant<uint32_t, t_values>...>;
+
+//! Carries a type to a visitor without constructing an object of it.
+template <class t_type>
+struct type_tag
+{
+    typedef t_type type;
+};
+
+//! Name of a template argument in experiment names.
+/*! Specialize it for every type used in a parameter list.
+ */
+template <class t_type>
+struct parameter_name;
+
+template <uint32_t t_value>
+struct parameter_name<std::integral_constant<uint32_t, t_value>>
+{
+    static std::string str()
+    {
+        return std::to_string(t_value);
+    }
+};
+
+template <>
+struct parameter_name<coder::elias_delta>
+{
+    static std::string str()
+    {
+        return "elias_delta";
+    }
+};
+
+template <>
+struct parameter_name<coder::elias_gamma>
+{
+    static std::string str()
+    {
+        return "elias_gamma";
+    }
+};
+
+template <>
+struct parameter_name<coder::fibonacci>
+{
+    static std::string str()
+    {
+        return "fibonacci";
+    }
+};
+
+namespace parameter_sweep_detail
+{
+
+template <class t_list, class t_type>
+struct push_front;
+
+template <class... t_types, class t_type>
+struct push_front<type_list<t_types...>, t_type>
+{
+    typedef type_list<t_type, t_types...> type;
+};
+
+//! type_list<L1 + f, L2 + f, ...> for t_lists = type_list<L1, L2, ...>.
+template <class t_front, class t_lists>
+struct push_front_each;
+
+template <class t_front, class... t_lists>
+struct push_front_each<t_front, type_list<t_lists...>>
+{
+    typedef type_list<typename push_front<t_lists, t_front>::type...> type;
+};
+
+template <class... t_lists>
+struct concat;
+
+template <>
+struct concat<>
+{
+    typedef type_list<> type;
+};
+
+template <class... t_types>
+struct concat<type_list<t_types...>>
+{
+    typedef type_list<t_types...> type;
+};
+
+template <class... t_first, class... t_second, class... t_rest>
+struct concat<type_list<t_first...>, type_list<t_second...>, t_rest...>
+{
+    typedef typename concat<type_list<t_first..., t_second...>, t_rest...>::type type;
+};
+
+} // end namespace parameter_sweep_detail
+
+//! All combinations of one element of every list, the last list varying fastest.
+/*! cartesian_product<type_list<A, B>, uint_list<1, 2>>::type is
+ *  type_list<type_list<A, 1>, type_list<A, 2>, type_list<B, 1>, type_list<B, 2>>.
+ */
+template <class... t_lists>
+struct cartesian_product;
+
+template <>
+struct cartesian_product<>
+{
+    typedef type_list<type_list<>> type;
+};
+
+template <class... t_types, class... t_lists>
+struct cartesian_product<type_list<t_types...>, t_lists...>
+{
+  private:
+    typedef typename cartesian_product<t_lists...>::type tail;
+
+  public:
+    typedef typename parameter_sweep_detail::concat<
+        typename parameter_sweep_detail::push_front_each<t_types, tail>::type...>::type type;
+};
+
+//! Names of the parameters t_params joined by _, e.g. elias_delta_16.
+template <class... t_params>
+std::string parameter_names()
+{
+    std::string names[] = {std::string(), parameter_name<t_params>::str()...};
+    std::string joined;
+    for (size_t i = 1; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        joined += (i > 1 ? "_" : "") + names[i];
+    }
+    return joined;
+}
+
+//! The configurations t_config<p1, ..., pn>::type for all p1 in t_lists[0], ..., pn in t_lists[n-1].
+/*! t_config is a class template with a member type, the structure built
+ *  from one combination of parameters. It has to be a class template since
+ *  alias templates can not take the expanded parameter pack. for_each calls
+ *  visitor(type_tag<t_config<...>::type>(), parameter_names<...>()) for every
+ *  combination, in the order of cartesian_product. Everything called by the
+ *  visitor is instantiated for every combination, so the lists multiply
+ *  the compile time.
+ */
+template <template <class...> class t_config, class... t_lists>
+class parameter_grid
+{
+  public:
+    typedef typename cartesian_product<t_lists...>::type points;
+
+  private:
+    template <class t_visitor, class... t_params>
+    static void visit(t_visitor &visitor, type_list<t_params...>)
+    {
+        visitor(type_tag<typename t_config<t_params...>::type>(), parameter_names<t_params...>());
+    }
+
+    template <class t_visitor, class... t_points>
+    static void visit_all(t_visitor &visitor, type_list<t_points...>)
+    {
+        int expand[] = {0, (visit(visitor, t_points()), 0)...};
+        (void)expand;
+    }
+
+  public:
+    template <class t_visitor>
+    static void for_each(t_visitor &visitor)
+    {
+        visit_all(visitor, points());
+    }
+};
+
+} // end namespace sdsl
+#endif
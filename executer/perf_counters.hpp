@@ -0,0 +1,191 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file perf_counters.hpp
+   \brief perf_counters.hpp contains a wrapper for the hardware performance counters of Linux.
+   \author Simon Gog
+*/
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Counter values of one measured phase.
+struct perf_sample
+{
+    enum event
+    {
+        cycles,
+        instructions,
+        llc_misses,
+        dtlb_misses,
+        branch_misses,
+        events
+    };
+
+    double values[events] = {0, 0, 0, 0, 0};
+    bool available[events] = {false, false, false, false, false};
+
+    static const char *name(uint32_t e)
+    {
+        static const char *names[events] = {"Cycles", "Instructions", "LLCMisses", "DTLBMisses", "BranchMisses"};
+        return names[e];
+    }
+
+    //! Print sep prefix Name PerOp=value/ops for every available counter.
+    void print(std::ostream &out, const std::string &prefix, uint64_t ops, const char *sep = " ") const
+    {
+        for (uint32_t e = 0; e < events; ++e)
+        {
+            if (available[e])
+            {
+                out << sep << prefix << name(e) << "PerOp=" << values[e] / (ops ? ops : 1);
+            }
+        }
+    }
+};
+
+//! Hardware performance counters of the calling thread and the threads it starts.
+/*! Every event is opened on its own, so a machine or a virtual machine
+ *  without e.g. dTLB events still reports the others. If perf_event_open
+ *  is not permitted (see /proc/sys/kernel/perf_event_paranoid) or the
+ *  system is not Linux, no counter is available and print writes nothing.
+ *  Values are scaled up if the kernel multiplexed the counters.
+ */
+class perf_counters
+{
+  private:
+    int m_fd[perf_sample::events];
+
+  public:
+    perf_counters()
+    {
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            m_fd[e] = -1;
+        }
+#ifdef __linux__
+        const uint32_t types[perf_sample::events] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                                      PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+        const uint64_t configs[perf_sample::events] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            m_fd[e] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+
+    ~perf_counters()
+    {
+#ifdef __linux__
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            if (m_fd[e] >= 0)
+            {
+                close(m_fd[e]);
+            }
+        }
+#endif
+    }
+
+    //! True if at least one counter could be opened.
+    bool available() const
+    {
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            if (m_fd[e] >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Reset and start the counters.
+    void start()
+    {
+#ifdef __linux__
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            if (m_fd[e] >= 0)
+            {
+                ioctl(m_fd[e], PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    //! Stop the counters and return their values since start.
+    perf_sample stop()
+    {
+        perf_sample sample;
+#ifdef __linux__
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            if (m_fd[e] >= 0)
+            {
+                ioctl(m_fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (uint32_t e = 0; e < perf_sample::events; ++e)
+        {
+            uint64_t data[3]; // value, time enabled, time running
+            if (m_fd[e] >= 0 && read(m_fd[e], data, sizeof(data)) == sizeof(data) && data[2] > 0)
+            {
+                sample.values[e] = static_cast<double>(data[0]) * data[1] / data[2];
+                sample.available[e] = true;
+            }
+        }
+#endif
+        return sample;
+    }
+};
+
+} // end namespace sdsl
+#endif
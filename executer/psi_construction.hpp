@@ -0,0 +1,248 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file psi_construction.hpp
+   \brief psi_construction.hpp contains the construction of the psi array used by the experiments.
+   \author Simon Gog
+*/
+#ifndef PSI_CONSTRUCTION
+#define PSI_CONSTRUCTION
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/int_vector_buffer.hpp>
+#include <sdsl/construct.hpp>
+#include <sdsl/construct_sa.hpp>
+#include <sdsl/config.hpp>
+#include <sdsl/io.hpp>
+
+#include "psi_runs.hpp"
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Seconds spent in the named stages of a construction, in order.
+typedef std::vector<std::pair<std::string, double>> construction_stages;
+
+//! Run f and append its time in seconds as stage name to stages.
+template <class t_func>
+void timed_stage(construction_stages &stages, const std::string &name, t_func f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stages.emplace_back(name, elapsed.count());
+}
+
+//! Construct the BWT of the text in test_file in memory.
+/*! The text is stored under conf::KEY_TEXT and the BWT under conf::KEY_BWT.
+ *  The suffix array is sorted by divsufsort in one thread, or by
+ *  parallel_suffix_sort with more threads; the BWT is read off it with
+ *  threads threads and the suffix array is not written to the cache. Text,
+ *  suffix array and BWT are in RAM at the same time.
+ */
+inline void construct_bwt_in_memory(cache_config &config, const std::string &test_file, uint64_t threads,
+                                    construction_stages &stages)
+{
+    int_vector<8> text;
+    timed_stage(stages, "Load", [&]() {
+        std::cout << "Load text..." << std::endl;
+        load_vector_from_file(text, test_file, 1);
+        append_zero_symbol(text);
+        store_to_cache(text, conf::KEY_TEXT, config);
+    });
+
+    int_vector<> sa(text.size(), 0, bits::hi(text.size()) + 1);
+    timed_stage(stages, "SuffixArray", [&]() {
+        std::cout << "Construct Suffix Array..." << std::endl;
+        if (threads > 1)
+        {
+            parallel_suffix_sort(text, sa, threads);
+        }
+        else
+        {
+            algorithm::calculate_sa((const unsigned char *)text.data(), text.size(), sa);
+        }
+    });
+
+    timed_stage(stages, "Bwt", [&]() {
+        std::cout << "Construct BWT..." << std::endl;
+        int_vector<8> bwt(text.size());
+        bwt_from_sa(text, sa, bwt, threads);
+        store_to_cache(bwt, conf::KEY_BWT, config);
+    });
+}
+
+//! Scans over the disk of a semi-external construction.
+struct external_scans
+{
+    uint64_t passes = 0;
+    //! Bytes read plus bytes written.
+    uint64_t bytes = 0;
+
+    void add(uint64_t read, uint64_t written)
+    {
+        ++passes;
+        bytes += read + written;
+    }
+};
+
+//! Construct psi from the BWT stored under conf::KEY_BWT in two scans.
+/*! psi[C[c]+k] is the position of the k-th c in the BWT. The first scan
+ *  appends every position of the BWT to the file of its symbol, the second
+ *  concatenates the files in symbol order into psi. The number of scans
+ *  does not depend on ram_budget, which only bounds the buffers of the at
+ *  most 256 symbol files.
+ */
+inline void construct_psi_from_bwt_external(cache_config &config, uint64_t ram_budget, external_scans &scans)
+{
+    int_vector_buffer<8> bwt(cache_file_name(conf::KEY_BWT, config));
+    uint64_t n = bwt.size();
+    uint8_t width = bits::hi(n) + 1;
+    uint64_t buffer_size = std::max((uint64_t)4096, ram_budget / 256);
+    uint64_t positions_bytes = (n * width + 7) / 8;
+
+    std::vector<std::unique_ptr<int_vector_buffer<>>> positions(256);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        uint8_t c = bwt[i];
+        if (!positions[c])
+        {
+            positions[c].reset(new int_vector_buffer<>(cache_file_name("psi_symbol_" + std::to_string(c), config),
+                                                       std::ios::out, buffer_size, width));
+        }
+        positions[c]->push_back(i);
+    }
+    scans.add(n, positions_bytes);
+
+    int_vector_buffer<> psi(cache_file_name(conf::KEY_PSI, config), std::ios::out, buffer_size, width);
+    for (auto &symbol_positions : positions)
+    {
+        if (!symbol_positions)
+        {
+            continue;
+        }
+        std::string file = symbol_positions->filename();
+        symbol_positions.reset();
+        int_vector_buffer<> in(file, std::ios::in, buffer_size);
+        for (uint64_t k = 0; k < in.size(); ++k)
+        {
+            psi.push_back(in[k]);
+        }
+        in.close(true);
+    }
+    psi.close();
+    scans.add(positions_bytes, positions_bytes);
+    register_cache_file(conf::KEY_PSI, config);
+}
+
+//! Construct the BWT and psi of the text in test_file within a RAM budget.
+/*! The suffix array is built semi-externally with SE-SAIS, the BWT is read
+ *  off it in one scan and psi is built from the BWT by
+ *  construct_psi_from_bwt_external, so neither the inverse suffix array
+ *  nor a full-width array is ever in RAM and the scans are independent of
+ *  the budget. The scans of SE-SAIS itself are not counted in scans.
+ *
+ *  SE-SAIS and the BWT scan keep the text (n bytes) in memory, which is the
+ *  lower bound of the peak memory of this construction; psi is built with
+ *  only the text and BWT freed.
+ *
+ *  \param ram_budget Bytes available for the buffers of the psi construction.
+ */
+inline void construct_psi_semi_external(cache_config &config, const std::string &test_file, uint64_t ram_budget,
+                                        construction_stages &stages, external_scans &scans)
+{
+    timed_stage(stages, "Load", [&]() {
+        std::cout << "Load text..." << std::endl;
+        int_vector<8> text;
+        load_vector_from_file(text, test_file, 1);
+        append_zero_symbol(text);
+        store_to_cache(text, conf::KEY_TEXT, config);
+    });
+
+    timed_stage(stages, "SuffixArray", [&]() {
+        std::cout << "Construct Suffix Array (semi-external)..." << std::endl;
+        byte_sa_algo_type sa_algo = construct_config::byte_algo_sa;
+        construct_config::byte_algo_sa = SE_SAIS;
+        construct_sa<8>(config);
+        construct_config::byte_algo_sa = sa_algo;
+    });
+
+    timed_stage(stages, "Bwt", [&]() {
+        std::cout << "Construct BWT..." << std::endl;
+        construct_bwt<8>(config);
+        int_vector_buffer<> sa(cache_file_name(conf::KEY_SA, config));
+        scans.add((sa.size() * sa.width() + 7) / 8, sa.size());
+    });
+
+    timed_stage(stages, "Psi", [&]() {
+        std::cout << "Construct Psi Array from BWT (semi-external)..." << std::endl;
+        construct_psi_from_bwt_external(config, ram_budget, scans);
+    });
+}
+
+//! Construct psi from the BWT stored under conf::KEY_BWT.
+/*! psi is written run by run from psi_runs, so text, suffix array and
+ *  inverse suffix array are not needed. With one thread the BWT is
+ *  streamed and apart from the buffers only the O(r) runs are in memory;
+ *  with more threads the BWT is loaded and run-length encoded in chunks.
+ */
+inline void construct_psi_from_bwt(cache_config &config, uint64_t threads, construction_stages &stages)
+{
+    psi_runs runs;
+    timed_stage(stages, "Runs", [&]() {
+        std::cout << "Construct Psi Runs from BWT..." << std::endl;
+        if (threads > 1)
+        {
+            int_vector<8> bwt;
+            load_from_cache(bwt, conf::KEY_BWT, config);
+            psi_runs tmp(bwt, threads);
+            std::swap(runs, tmp);
+        }
+        else
+        {
+            int_vector_buffer<8> bwt(cache_file_name(conf::KEY_BWT, config));
+            psi_runs tmp(bwt);
+            std::swap(runs, tmp);
+        }
+    });
+
+    timed_stage(stages, "Psi", [&]() {
+        std::cout << "Construct Psi Array from Runs..." << std::endl;
+        int_vector_buffer<> psi(cache_file_name(conf::KEY_PSI, config), std::ios::out, 1024 * 1024,
+                                bits::hi(runs.size()) + 1);
+        for (psi_runs::size_type k = 0; k < runs.runs(); ++k)
+        {
+            for (psi_runs::size_type j = 0; j < runs.length(k); ++j)
+            {
+                psi.push_back(runs.value(k) + j);
+            }
+        }
+        psi.close();
+        register_cache_file(conf::KEY_PSI, config);
+    });
+}
+
+} // end namespace sdsl
+#endif
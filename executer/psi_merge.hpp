@@ -0,0 +1,210 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file psi_merge.hpp
+   \brief psi_merge.hpp contains the merge of the psi vector of a collection with a new text.
+   \author Simon Gog
+*/
+#ifndef PSI_MERGE
+#define PSI_MERGE
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/select_support.hpp>
+#include <sdsl/construct_sa.hpp>
+
+#include "rlcsa_psi_vector.hpp"
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Add the symbols of text to C, where C[c] counts the symbols smaller than c.
+/*! C has 257 entries, start with int_vector<64>(257, 0). The C array of a
+ *  merged collection is the sum of the C arrays of its texts.
+ */
+inline void add_symbol_counts(int_vector<64> &C, const int_vector<8> &text)
+{
+    int_vector<64> count(257, 0);
+    for (int_vector<8>::size_type i = 0; i < text.size(); ++i)
+    {
+        ++count[text[i] + 1];
+    }
+    for (int_vector<64>::size_type c = 1; c < count.size(); ++c)
+    {
+        count[c] += count[c - 1];
+        C[c] += count[c];
+    }
+}
+
+//! Merge the psi of a collection with a new text, value by value.
+/*! A collection is a concatenation of texts, each ending with the symbol 0.
+ *  Its suffixes are ordered as in RLCSA: the terminators compare by their
+ *  text position, so a suffix ends at its terminator and the suffixes of one
+ *  text keep their order when texts are appended. psi1 is the psi of a
+ *  collection, e.g. of a single text as built by construct_psi_from_bwt,
+ *  and C1 its C array. text2 ends with its only 0.
+ *
+ *  Only text2 is suffix sorted. The rank r of every suffix of text2 among
+ *  the suffixes of the collection is found by backward search of text2 on
+ *  psi1, one range_search per symbol. The merged order interleaves both:
+ *  the suffixes of text2 with rank r precede the suffix r of the
+ *  collection. The collection suffix with psi1 value v therefore has
+ *  merged rank v plus the number of ranks r <= v, and the suffix of text2
+ *  with rank k has merged rank r[k] + k. The terminator of the collection
+ *  now leads to the start of text2 and the terminator of text2 wraps
+ *  around to the start of the collection.
+ *
+ *  Apart from psi1, which is read sequentially, the merge holds O(n2)
+ *  words for the text2 of length n2 and a bit vector of the merged order
+ *  with constant time select, which answers every merged rank.
+ *
+ *  \param sink Called with the merged psi values in order.
+ */
+template <class t_psi_vector, class t_sink>
+void merge_psi(const t_psi_vector &psi1, const int_vector<64> &C1, const int_vector<8> &text2, t_sink sink)
+{
+    typedef int_vector<>::size_type size_type;
+    size_type n1 = psi1.size();
+    size_type n2 = text2.size();
+    size_type texts = C1[1]; // terminators in the collection
+    if (n1 == 0 || texts == 0 || n2 == 0 || text2[n2 - 1] != 0)
+    {
+        throw std::invalid_argument("merge_psi: needs a collection and a new text ending with 0");
+    }
+
+    // psi2 of text2, and the rank among the suffixes of the collection of
+    // every suffix of text2, in the order of text2. The inverse suffix array
+    // maps text positions of text2 to its ranks.
+    int_vector<> psi2(n2, 0, bits::hi(n2) + 1);
+    int_vector<> rank1(n2, 0, bits::hi(n1) + 1);
+    {
+        int_vector<> isa2(n2, 0, bits::hi(n2) + 1);
+        {
+            int_vector<> sa2(n2, 0, bits::hi(n2) + 1);
+            algorithm::calculate_sa((const unsigned char *)text2.data(), n2, sa2);
+            for (size_type k = 0; k < n2; ++k)
+            {
+                isa2[sa2[k]] = k;
+            }
+            for (size_type k = 0; k < n2; ++k)
+            {
+                psi2[k] = isa2[sa2[k] + 1 < n2 ? sa2[k] + 1 : 0];
+            }
+        }
+
+        // Backward search of text2 on psi1. The terminator of text2 follows
+        // the terminators of the collection and precedes everything else.
+        rank1[isa2[n2 - 1]] = texts;
+        for (size_type j = n2 - 1, r = texts; j-- > 0;)
+        {
+            unsigned char c = text2[j];
+            size_type lo = C1[c], hi = C1[c + 1];
+            size_type less = lo;
+            if (lo < hi && r > 0)
+            {
+                // psi1 is increasing on [lo, hi), which lies inside one bucket.
+                size_type bucket = psi1.bucket(lo);
+                size_type end = psi1.range_search(bucket, 0, r - 1).second;
+                less = std::min(std::max(end, lo), hi);
+            }
+            r = less;
+            rank1[isa2[j]] = r;
+        }
+    }
+
+    // The suffix k of text2 has merged rank rank1[k] + k and the collection
+    // suffixes fill the other positions in order, so the merged rank of
+    // collection suffix v is the position of the (v+1)-th zero of merged2.
+    bit_vector merged2(n1 + n2, 0);
+    for (size_type k = 0; k < n2; ++k)
+    {
+        merged2[rank1[k] + k] = 1;
+    }
+    select_support_mcl<0> select_merged1(&merged2);
+    auto merged_rank1 = [&select_merged1](size_type v) { return select_merged1(v + 1); };
+    auto merged_rank2 = [&rank1](size_type k) { return rank1[k] + k; };
+    size_type last1 = texts - 1; // terminator of the last text of the collection
+    size_type start1 = psi1[last1];
+
+    auto emit2 = [&](size_type k) {
+        sink(k == 0 ? merged_rank1(start1) : merged_rank2(psi2[k]));
+    };
+    size_type k = 0;
+    size_type i = 0;
+    for (auto it = psi1.begin(); it != psi1.end(); ++it, ++i)
+    {
+        for (; k < n2 && rank1[k] <= i; ++k)
+        {
+            emit2(k);
+        }
+        sink(i == last1 ? merged_rank2(psi2[0]) : merged_rank1(*it));
+    }
+    for (; k < n2; ++k)
+    {
+        emit2(k);
+    }
+}
+
+//! The merged psi of psi1 and text2 as an int_vector, see merge_psi.
+template <class t_psi_vector>
+int_vector<> merged_psi(const t_psi_vector &psi1, const int_vector<64> &C1, const int_vector<8> &text2)
+{
+    typedef int_vector<>::size_type size_type;
+    size_type n = psi1.size() + text2.size();
+    int_vector<> psi(n, 0, bits::hi(n) + 1);
+    size_type i = 0;
+    merge_psi(psi1, C1, text2, [&psi, &i](uint64_t v) { psi[i++] = v; });
+    return psi;
+}
+
+//! Merge psi1 with text2 into merged, see merge_psi.
+/*! The merged psi is materialized and encoded with threads threads.
+ */
+template <class t_psi_vector>
+void merge_psi_vectors(const t_psi_vector &psi1, const int_vector<64> &C1, const int_vector<8> &text2,
+                       t_psi_vector &merged, int_vector<>::size_type threads = 1)
+{
+    t_psi_vector tmp(merged_psi(psi1, C1, text2), threads);
+    merged.swap(tmp);
+}
+
+//! Merge psi1 with text2 into merged, see merge_psi.
+/*! With one thread the merged psi is streamed into an
+ *  rlcsa_psi_vector_builder and never materialized. With more threads it
+ *  is materialized, so that its buckets are encoded in parallel.
+ */
+template <class t_boundaries, uint32_t t_block_size>
+void merge_psi_vectors(const rlcsa_psi_vector<t_boundaries, t_block_size> &psi1, const int_vector<64> &C1,
+                       const int_vector<8> &text2, rlcsa_psi_vector<t_boundaries, t_block_size> &merged,
+                       int_vector<>::size_type threads = 1)
+{
+    if (threads > 1)
+    {
+        rlcsa_psi_vector<t_boundaries, t_block_size> tmp(merged_psi(psi1, C1, text2), threads);
+        merged.swap(tmp);
+        return;
+    }
+    rlcsa_psi_vector_builder<t_boundaries, t_block_size> builder(psi1.size() + text2.size());
+    merge_psi(psi1, C1, text2, [&builder](uint64_t v) { builder.push_back(v); });
+    rlcsa_psi_vector<t_boundaries, t_block_size> tmp(builder);
+    merged.swap(tmp);
+}
+
+} // end namespace sdsl
+#endif
@@ -0,0 +1,224 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file psi_runs.hpp
+   \brief psi_runs.hpp contains the runs of psi read off the BWT.
+   \author Simon Gog
+*/
+#ifndef PSI_RUNS
+#define PSI_RUNS
+
+#include <vector>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/int_vector_buffer.hpp>
+
+#include "parallel_construction.hpp"
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! The runs of psi, computed from the BWT without suffix array or inverse suffix array.
+/*! psi is the inverse of LF: the k-th position of the F column that holds
+ *  symbol c points to the k-th occurrence of c in the BWT, i.e.
+ *  psi[C[c]+k] = select_c(bwt, k+1). A run of c in the BWT is therefore a
+ *  run of consecutive psi values, and psi is the concatenation of the BWT
+ *  runs of every symbol in symbol order. A run is (first value, length),
+ *  runs of neighbouring symbols that continue each other are merged, and
+ *  a bucket starts at every run whose first value is smaller than its
+ *  predecessor, exactly as the psi vectors split psi.
+ *
+ *  The BWT is read once and only the runs are kept, i.e. O(r) words.
+ *  A BWT in memory can be split into chunks encoded in parallel.
+ */
+class psi_runs
+{
+  public:
+    typedef int_vector<>::size_type size_type;
+
+  private:
+    size_type m_size = 0;                // length of psi
+    std::vector<uint64_t> m_values;      // first psi value of each run
+    std::vector<uint64_t> m_heads;       // first psi position of each run, plus m_size
+    std::vector<uint64_t> m_bucket_runs; // first run of each bucket, plus runs()
+
+    typedef std::vector<std::vector<std::pair<uint64_t, uint64_t>>> symbol_runs_type; // (BWT position, length) per symbol
+
+    //! Concatenate the BWT runs of every symbol in symbol order.
+    void init(symbol_runs_type &symbol_runs)
+    {
+        size_type pos = 0;
+        for (auto &runs : symbol_runs)
+        {
+            for (auto &run : runs)
+            {
+                uint64_t next = m_values.empty() ? 0 : m_values.back() + (pos - m_heads.back());
+                if (!m_values.empty() && run.first == next)
+                {
+                    pos += run.second;
+                    continue;
+                }
+                if (m_values.empty() || run.first < next)
+                {
+                    m_bucket_runs.push_back(m_values.size());
+                }
+                m_values.push_back(run.first);
+                m_heads.push_back(pos);
+                pos += run.second;
+            }
+            std::vector<std::pair<uint64_t, uint64_t>>().swap(runs);
+        }
+        m_heads.push_back(m_size);
+        m_bucket_runs.push_back(m_values.size());
+    }
+
+  public:
+    psi_runs() = default;
+
+    //! Constructor for a BWT stored in the cache.
+    template <uint8_t int_width>
+    explicit psi_runs(int_vector_buffer<int_width> &bwt)
+    {
+        m_size = bwt.size();
+        symbol_runs_type symbol_runs;
+        for (size_type i = 0; i < m_size;)
+        {
+            uint64_t c = bwt[i];
+            size_type j = i + 1;
+            while (j < m_size && bwt[j] == c)
+            {
+                ++j;
+            }
+            if (c >= symbol_runs.size())
+            {
+                symbol_runs.resize(c + 1);
+            }
+            symbol_runs[c].emplace_back(i, j - i);
+            i = j;
+        }
+        init(symbol_runs);
+    }
+
+    //! Constructor for a BWT in memory, run-length encoded in chunks on threads threads.
+    /*! Every thread collects the runs of its chunk per symbol. The chunk
+     *  lists are concatenated in order, joining the runs split at a chunk
+     *  border, so the result does not depend on threads.
+     */
+    psi_runs(const int_vector<8> &bwt, uint64_t threads)
+    {
+        m_size = bwt.size();
+        std::vector<symbol_runs_type> chunk_runs(std::max((uint64_t)1, threads));
+        parallel_for_chunks(m_size, threads, [&](uint64_t t, uint64_t begin, uint64_t end) {
+            symbol_runs_type &symbol_runs = chunk_runs[t];
+            for (size_type i = begin; i < end;)
+            {
+                uint64_t c = bwt[i];
+                size_type j = i + 1;
+                while (j < end && bwt[j] == c)
+                {
+                    ++j;
+                }
+                if (c >= symbol_runs.size())
+                {
+                    symbol_runs.resize(c + 1);
+                }
+                symbol_runs[c].emplace_back(i, j - i);
+                i = j;
+            }
+        });
+
+        symbol_runs_type symbol_runs;
+        for (auto &chunk : chunk_runs)
+        {
+            if (chunk.size() > symbol_runs.size())
+            {
+                symbol_runs.resize(chunk.size());
+            }
+            for (size_type c = 0; c < chunk.size(); ++c)
+            {
+                auto &runs = symbol_runs[c];
+                for (auto &run : chunk[c])
+                {
+                    if (!runs.empty() && runs.back().first + runs.back().second == run.first)
+                    {
+                        runs.back().second += run.second;
+                    }
+                    else
+                    {
+                        runs.push_back(run);
+                    }
+                }
+            }
+            symbol_runs_type().swap(chunk);
+        }
+        init(symbol_runs);
+    }
+
+    //! Length of psi.
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    //! Number of runs.
+    size_type runs() const
+    {
+        return m_values.size();
+    }
+
+    //! Number of buckets.
+    size_type buckets() const
+    {
+        return m_bucket_runs.size() - 1;
+    }
+
+    //! First psi value of run k.
+    uint64_t value(size_type k) const
+    {
+        return m_values[k];
+    }
+
+    //! First psi position of run k, head(runs()) is size().
+    size_type head(size_type k) const
+    {
+        return m_heads[k];
+    }
+
+    //! Length of run k.
+    size_type length(size_type k) const
+    {
+        return m_heads[k + 1] - m_heads[k];
+    }
+
+    //! First run of bucket b, bucket_begin(buckets()) is runs().
+    size_type bucket_begin(size_type b) const
+    {
+        return m_bucket_runs[b];
+    }
+
+    //! Mark the bucket starts and size() in marker, a bit vector of length size()+1.
+    void mark_buckets(bit_vector &marker) const
+    {
+        for (size_type b = 0; b <= buckets(); ++b)
+        {
+            marker[m_heads[m_bucket_runs[b]]] = 1;
+        }
+    }
+};
+
+} // end namespace sdsl
+#endif
@@ -22,6 +22,15 @@
 #define RLCSA_PSI_VECTOR
 
 #include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <stdexcept>
+#include <limits>
+#include <fstream>
+#include <streambuf>
 
 #include <sdsl/int_vector.hpp>
 #include <sdsl/enc_vector.hpp>
@@ -31,12 +40,58 @@
 #include <sdsl/coder.hpp>
 #include <sdsl/iterators.hpp>
 
+#include "alphabet_boundaries.hpp"
+#include "parallel_construction.hpp"
+#include "psi_runs.hpp"
+
 #include "bits/rlevector.h"
 
 //! Namespace for the succinct data structure library.
 namespace sdsl
 {
 
+template <class t_boundaries, uint32_t t_block_size>
+class rlcsa_psi_vector_builder;
+
+namespace rlcsa_psi_vector_detail
+{
+
+//! Stream buffer passing the bytes written to another one through and counting them.
+class counting_streambuf : public std::streambuf
+{
+  private:
+    std::streambuf *m_sink;
+    uint64_t m_count = 0;
+
+  protected:
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            return traits_type::not_eof(c);
+        }
+        ++m_count;
+        return m_sink->sputc(traits_type::to_char_type(c));
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        std::streamsize written = m_sink->sputn(s, n);
+        m_count += written;
+        return written;
+    }
+
+  public:
+    explicit counting_streambuf(std::streambuf *sink) : m_sink(sink) {}
+
+    uint64_t count() const
+    {
+        return m_count;
+    }
+};
+
+} // end namespace rlcsa_psi_vector_detail
+
 //! A generic immutable space-saving vector class for unsigned integers.
 /*! A vector v is stored more space-efficiently by self-delimiting coding
  *  the deltas v[i+1]-v[i] (v[-1]:=0). Space of the structure and random
@@ -46,21 +101,32 @@ namespace sdsl
  *  \tparam t_dens   Every t_dens-th element of v is sampled.
  *  \tparam t_width  Width of the int_vector used to store the samples and pointers.
  *  This class is a parameter of csa_sada.
+ *
+ *  \tparam t_boundaries Bucket boundaries of psi.
+ *  \tparam t_block_size Block size of the RLEVector of each bucket in bytes.
+ *
+ *  serialize writes the RLEVectors as RLCSA does, so size_in_bytes is the
+ *  space of RLCSA, and their block size, which load checks against
+ *  t_block_size. rlcsa_run_table is a separate index of the decoded
+ *  runs that is mapped instead of loaded.
+ *
+ *  The RLEVectors store positions as CSA::usint, which is 32 bits unless
+ *  RLCSA is compiled with -DMASSIVE_DATA_RLCSA. Longer vectors are
+ *  rejected with std::length_error, see max_size().
  * @ingroup int_vector
  */
+template <class t_boundaries = small_alphabet_boundaries<>, uint32_t t_block_size = 32>
 class rlcsa_psi_vector
 {
   private:
-    //static_assert(t_dens > 1 , "rlcsa_psi_vector: sample density must be larger than `1`");
+    static_assert(t_block_size >= 8 && t_block_size % 8 == 0, "rlcsa_psi_vector: block size must be a positive multiple of 8 bytes");
   public:
     typedef uint64_t value_type;
-    typedef random_access_const_iterator<rlcsa_psi_vector> iterator;
-    typedef iterator const_iterator;
+    class const_iterator;
+    typedef const_iterator iterator;
     typedef ptrdiff_t difference_type;
     typedef int_vector<>::size_type size_type;
     typedef iv_tag index_category;
-    typedef typename sd_vector<>::rank_1_type rank_support;
-    typedef typename sd_vector<>::select_1_type select_support;
 
     typedef CSA::RLEVector PsiVector;
     typedef std::pair<size_type, size_type> pair_type;
@@ -69,10 +135,8 @@ class rlcsa_psi_vector
     size_type m_size = 0; // number of vector elements
     size_type m_alphabet_size = 0;
 
-    std::vector<PsiVector*> m_c;
-    sd_vector<> m_alphabet_marker;
-    rank_support m_alphabet_rank;
-    select_support m_alphabet_select;
+    std::vector<std::unique_ptr<PsiVector>> m_c; // owned RLEVector of every bucket
+    t_boundaries m_boundaries;
 
     void
     clear()
@@ -81,28 +145,52 @@ class rlcsa_psi_vector
         m_alphabet_size = 0;
     }
 
+    //! Throw std::length_error if the RLEVectors can not address n elements.
+    static void check_size(size_type n)
+    {
+        if (n > max_size())
+        {
+            throw std::length_error("rlcsa_psi_vector: " + std::to_string(n) + " elements exceed the " +
+                                    std::to_string(8 * sizeof(CSA::usint)) +
+                                    " bit positions of RLCSA, compile with -DMASSIVE_DATA_RLCSA");
+        }
+    }
+
   public:
     rlcsa_psi_vector() = default;
-    rlcsa_psi_vector(const rlcsa_psi_vector &) = default;
+    //! The RLEVectors are owned, so the vector is moved and not copied.
+    rlcsa_psi_vector(const rlcsa_psi_vector &) = delete;
     rlcsa_psi_vector(rlcsa_psi_vector &&) = default;
-    rlcsa_psi_vector &operator=(const rlcsa_psi_vector &) = default;
+    rlcsa_psi_vector &operator=(const rlcsa_psi_vector &) = delete;
     rlcsa_psi_vector &operator=(rlcsa_psi_vector &&) = default;
 
     //! Constructor for a Container of unsigned integers.
     /*! \param c A container of unsigned integers.
+     *  \param threads Number of threads encoding the buckets.
           */
     template <class Container>
-    rlcsa_psi_vector(const Container &c);
+    rlcsa_psi_vector(const Container &c, size_type threads = 1);
+
+    //! Constructor for the runs of psi read off the BWT.
+    /*! The runs are fed to the encoders directly, psi is never materialized.
+     *  \param runs    The runs of psi.
+     *  \param threads Number of threads encoding the buckets.
+     */
+    rlcsa_psi_vector(const psi_runs &runs, size_type threads = 1);
 
     //! Constructor for an int_vector_buffer of unsigned integers.
-    /*
-            \param v_buf A int_vector_buf.
+    /*! v_buf is read once front to back by an rlcsa_psi_vector_builder,
+     *  so it may be a file much larger than the memory.
+     *  \param v_buf A int_vector_buf.
         */
     template <uint8_t int_width>
     rlcsa_psi_vector(int_vector_buffer<int_width> &v_buf);
 
-    //! Default Destructor
-    ~rlcsa_psi_vector() {}
+    //! Constructor for the buckets encoded by builder, which is left empty.
+    explicit rlcsa_psi_vector(rlcsa_psi_vector_builder<t_boundaries, t_block_size> &builder);
+
+    //! Default Destructor, which frees the RLEVectors.
+    ~rlcsa_psi_vector() = default;
 
     //! The number of elements in the rlcsa_psi_vector.
     size_type size() const
@@ -110,10 +198,10 @@ class rlcsa_psi_vector
         return m_size;
     }
 
-    //! Return the largest size that this container can ever have.
+    //! Return the largest size that this container can ever have, bounded by the positions of RLCSA.
     static size_type max_size()
     {
-        return int_vector<>::max_size() / 2;
+        return std::min<size_type>(int_vector<>::max_size() / 2, std::numeric_limits<CSA::usint>::max());
     }
 
     //!    Returns if the rlcsa_psi_vector is empty.
@@ -142,6 +230,44 @@ class rlcsa_psi_vector
          */
     value_type operator[](size_type i) const;
 
+    //! Access a batch of positions.
+    /*! The queries are sorted, so the bucket boundaries are resolved once
+     *  per bucket. Within a bucket a run cursor answers every query in the
+     *  current run without decoding, and queries up to t_block_size
+     *  positions past it are reached with selectNextRun instead of a new
+     *  select.
+     *  \param idx   Positions to access.
+     *  \param n     Number of positions.
+     *  \param out   Receives psi[idx[k]] in out[k].
+     *  \param order Scratch space of n entries.
+         */
+    void access_batch(const uint64_t *idx, size_t n, uint64_t *out, uint64_t *order) const;
+
+    //! Number of buckets.
+    size_type buckets() const
+    {
+        return m_alphabet_size;
+    }
+
+    //! Bucket containing position i.
+    size_type bucket(size_type i) const
+    {
+        return m_boundaries.bucket(i);
+    }
+
+    //! First position of bucket c, bucket_start(buckets()) is size().
+    size_type bucket_start(size_type c) const
+    {
+        return m_boundaries.start(c);
+    }
+
+    //! Positions of bucket c whose psi values lie in [lo, hi].
+    /*! psi is increasing in a bucket, so the positions form an interval.
+     *  It takes two rank queries on the run-length encoded bucket.
+     *  \return The interval [first, last) of positions, empty if first == last.
+     */
+    std::pair<size_type, size_type> range_search(size_type c, value_type lo, value_type hi) const;
+
     //! Serialize the rlcsa_psi_vector to a stream.
     /*! \param out Out stream to write the data structure.
             \return The number of written bytes.
@@ -149,19 +275,198 @@ class rlcsa_psi_vector
     size_type serialize(std::ostream &out, structure_tree_node *v = nullptr, std::string name = "") const;
 
     //! Load the rlcsa_psi_vector from a stream.
+    /*! The RLEVectors are not re-encoded, so a stream serialized with
+     *  another block size is rejected with std::runtime_error.
+     */
     void load(std::istream &in);
+
+
+  public:
+    //! Forward iterator decoding the psi vector sequentially.
+    /*! The iterator keeps one PsiVector::Iterator on the current bucket and
+     *  advances it with selectNext(), so the alphabet marker is only queried
+     *  when a bucket boundary is crossed and a full scan costs amortized
+     *  O(1) per element.
+     */
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename rlcsa_psi_vector::value_type value_type;
+        typedef typename rlcsa_psi_vector::difference_type difference_type;
+        typedef const value_type *pointer;
+        typedef value_type reference;
+
+      private:
+        const rlcsa_psi_vector *m_v = nullptr;
+        size_type m_i = 0;
+        size_type m_alphabet = 0;
+        size_type m_bucket_end = 0;
+        value_type m_val = 0;
+        std::unique_ptr<PsiVector::Iterator> m_iter;
+
+        void seek()
+        {
+            if (m_v == nullptr || m_i >= m_v->m_size)
+            {
+                m_iter.reset();
+                return;
+            }
+            size_type alphabet_start_pos;
+            if (m_iter && m_i == m_bucket_end)
+            {
+                ++m_alphabet;
+                alphabet_start_pos = m_bucket_end;
+            }
+            else
+            {
+                m_alphabet = m_v->m_boundaries.bucket(m_i);
+                alphabet_start_pos = m_v->m_boundaries.start(m_alphabet);
+            }
+            m_bucket_end = m_v->m_boundaries.start(m_alphabet + 1);
+            m_iter.reset(new PsiVector::Iterator(*(m_v->m_c[m_alphabet])));
+            m_val = m_iter->select(m_i - alphabet_start_pos);
+        }
+
+      public:
+        const_iterator() = default;
+
+        const_iterator(const rlcsa_psi_vector *v, size_type i) : m_v(v), m_i(i)
+        {
+            seek();
+        }
+
+        //! PsiVector::Iterator can not be copied, the copy seeks to the same position.
+        const_iterator(const const_iterator &it) : m_v(it.m_v), m_i(it.m_i)
+        {
+            seek();
+        }
+
+        const_iterator &operator=(const const_iterator &it)
+        {
+            if (this != &it)
+            {
+                m_v = it.m_v;
+                m_i = it.m_i;
+                m_iter.reset();
+                seek();
+            }
+            return *this;
+        }
+
+        reference operator*() const
+        {
+            return m_val;
+        }
+
+        const_iterator &operator++()
+        {
+            if (++m_i < m_bucket_end)
+                m_val = m_iter->selectNext();
+            else
+                seek();
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const const_iterator &it) const
+        {
+            return m_v == it.m_v && m_i == it.m_i;
+        }
+
+        bool operator!=(const const_iterator &it) const
+        {
+            return !(*this == it);
+        }
+    };
 };
 
-inline typename rlcsa_psi_vector::value_type
-    rlcsa_psi_vector::operator[](const size_type i) const
+template <class t_boundaries, uint32_t t_block_size>
+inline typename rlcsa_psi_vector<t_boundaries, t_block_size>::value_type
+    rlcsa_psi_vector<t_boundaries, t_block_size>::operator[](const size_type i) const
 {
-    size_type alphabet = m_alphabet_rank(i + 1) - 1;
-    size_type alphabet_start_pos = m_alphabet_select(alphabet + 1);
+    size_type alphabet = m_boundaries.bucket(i);
+    size_type alphabet_start_pos = m_boundaries.start(alphabet);
     PsiVector::Iterator iter(*(m_c[alphabet]));
     value_type val = iter.select(i - alphabet_start_pos);
     return val;
 }
 
+template <class t_boundaries, uint32_t t_block_size>
+inline void rlcsa_psi_vector<t_boundaries, t_block_size>::access_batch(const uint64_t *idx, size_t n, uint64_t *out, uint64_t *order) const
+{
+    std::iota(order, order + n, 0);
+    std::sort(order, order + n, [idx](uint64_t a, uint64_t b) { return idx[a] < idx[b]; });
+    size_type k = 0;
+    while (k < n)
+    {
+        size_type alphabet = m_boundaries.bucket(idx[order[k]]);
+        size_type alphabet_start_pos = m_boundaries.start(alphabet);
+        size_type alphabet_end_pos = m_boundaries.start(alphabet + 1);
+        size_type bucket_size = alphabet_end_pos - alphabet_start_pos;
+        PsiVector::Iterator iter(*(m_c[alphabet]));
+        // Positions [run_pos, run_end] of the bucket hold run_value + (pos - run_pos).
+        size_type run_pos = 0, run_end = 0;
+        value_type run_value = 0;
+        bool in_run = false;
+        for (; k < n && idx[order[k]] < alphabet_end_pos; ++k)
+        {
+            size_type pos = idx[order[k]] - alphabet_start_pos;
+            if (in_run && pos > run_end && pos - run_end <= t_block_size)
+            {
+                // Every run covers a position, so this takes at most t_block_size steps.
+                while (pos > run_end)
+                {
+                    pair_type run = iter.selectNextRun(bucket_size);
+                    run_pos = run_end + 1;
+                    run_value = run.first;
+                    run_end = run_pos + run.second;
+                }
+            }
+            else if (!in_run || pos > run_end)
+            {
+                pair_type run = iter.selectRun(pos, bucket_size);
+                run_pos = pos;
+                run_value = run.first;
+                run_end = pos + run.second;
+                in_run = true;
+            }
+            out[order[k]] = run_value + (pos - run_pos);
+        }
+    }
+}
+
+template <class t_boundaries, uint32_t t_block_size>
+inline std::pair<typename rlcsa_psi_vector<t_boundaries, t_block_size>::size_type, typename rlcsa_psi_vector<t_boundaries, t_block_size>::size_type>
+rlcsa_psi_vector<t_boundaries, t_block_size>::range_search(size_type c, value_type lo, value_type hi) const
+{
+    size_type start = m_boundaries.start(c);
+    if (lo > hi)
+    {
+        return std::make_pair(start, start);
+    }
+    // rank answers every value at or past the universe of the bucket with
+    // the number of its values, so lo and hi are clamped to the universe.
+    value_type universe = m_c[c]->getSize();
+    if (lo >= universe)
+    {
+        size_type end = m_boundaries.start(c + 1);
+        return std::make_pair(end, end);
+    }
+    hi = std::min(hi, universe - 1);
+    // rank(v) counts the values <= v, rank(v, true) the values < v plus one.
+    PsiVector::Iterator iter(*(m_c[c]));
+    size_type first = iter.rank(lo, true) - 1;
+    size_type last = iter.rank(hi);
+    return std::make_pair(start + first, start + last);
+}
+
 /*template<class t_int_vector, class t_bit_vector, uint32_t t_dens, uint8_t t_width>
 inline typename rlcsa_psi_vector<t_coder, t_dens,t_width>::value_type rlcsa_psi_vector<t_coder, t_dens,t_width>::sample(const size_type i)const
 {
@@ -170,44 +475,38 @@ inline typename rlcsa_psi_vector<t_coder, t_dens,t_width>::value_type rlcsa_psi_
     return m_sample_vals_and_pointer[i<<1];
 }*/
 
-void rlcsa_psi_vector::swap(rlcsa_psi_vector &v)
+template <class t_boundaries, uint32_t t_block_size>
+void rlcsa_psi_vector<t_boundaries, t_block_size>::swap(rlcsa_psi_vector<t_boundaries, t_block_size> &v)
 {
     if (this != &v)
     {
+        std::swap(m_size, v.m_size);
+        std::swap(m_alphabet_size, v.m_alphabet_size);
+        m_c.swap(v.m_c);
+        std::swap(m_boundaries, v.m_boundaries);
     }
 }
 
+template <class t_boundaries, uint32_t t_block_size>
 template <class Container>
-rlcsa_psi_vector::rlcsa_psi_vector(const Container &c)
+rlcsa_psi_vector<t_boundaries, t_block_size>::rlcsa_psi_vector(const Container &c, size_type threads)
 {
 
     // clear bit_vectors
+    check_size(c.size());
     clear();
     m_size = c.size();
 
     bit_vector alphabet_marker(m_size + 1, 0);
-    alphabet_marker[0] = 1;
-    alphabet_marker[m_size] = 1;
-    m_alphabet_size = 1;
-    for (size_type i = 1; i < m_size; ++i)
-    {
-        if (c[i] < c[i - 1])
-        {
-            alphabet_marker[i] = 1;
-            m_alphabet_size++;
-        }
-    }
-    m_alphabet_marker = sd_vector<>(alphabet_marker);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    m_alphabet_size = mark_alphabet_boundaries(c, alphabet_marker, threads);
+    m_boundaries = t_boundaries(alphabet_marker);
 
     m_c.resize(m_alphabet_size);
-    for (size_type i = 0; i < m_alphabet_size; ++i)
-    {
-        size_type start = m_alphabet_select(i + 1);
-        size_type end = m_alphabet_select(i + 2);
+    parallel_for_buckets(m_boundaries, m_alphabet_size, threads, [&](size_type i) {
+        size_type start = m_boundaries.start(i);
+        size_type end = m_boundaries.start(i + 1);
         pair_type run(c[start++], 1);
-        PsiVector::Encoder encoder(32);
+        PsiVector::Encoder encoder(t_block_size);
         for (; start < end; ++start)
         {
             if (c[start] == run.first + run.second)
@@ -223,84 +522,239 @@ rlcsa_psi_vector::rlcsa_psi_vector(const Container &c)
         encoder.addRun(run.first, run.second);
         encoder.flush();
 
-        m_c[i] = new PsiVector(encoder, m_size);
-    }
+        m_c[i].reset(new PsiVector(encoder, m_size));
+    });
 }
 
-template <uint8_t int_width>
-rlcsa_psi_vector::rlcsa_psi_vector(int_vector_buffer<int_width> &v_buf)
+template <class t_boundaries, uint32_t t_block_size>
+rlcsa_psi_vector<t_boundaries, t_block_size>::rlcsa_psi_vector(const psi_runs &runs, size_type threads)
 {
-    // clear bit_vectors
+    check_size(runs.size());
     clear();
-    m_size = v_buf.size();
+    m_size = runs.size();
 
-    bit_vector alphabet_marker(m_size + 1, 0);
-    alphabet_marker[0] = 1;
-    alphabet_marker[m_size] = 1;
-    m_alphabet_size = 1;
-    for (size_type i = 1; i < m_size; ++i)
+    // The bucket starts are run heads, so no bit vector of length n is needed.
+    std::vector<uint64_t> starts;
+    for (size_type b = 0; b <= runs.buckets(); ++b)
     {
-        if (v_buf[i] < v_buf[i - 1])
-        {
-            alphabet_marker[i] = 1;
-            m_alphabet_size++;
-        }
+        starts.push_back(runs.head(runs.bucket_begin(b)));
     }
-    m_alphabet_marker = sd_vector<>(alphabet_marker);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    m_alphabet_size = runs.buckets();
+    m_boundaries = t_boundaries(starts);
 
     m_c.resize(m_alphabet_size);
-    for (size_type i = 0; i < m_alphabet_size; ++i)
-    {
-        size_type start = m_alphabet_select(i + 1);
-        size_type end = m_alphabet_select(i + 2);
-        pair_type run(v_buf[start++], 1);
-        PsiVector::Encoder encoder(32);
-        for (; start < end; ++start)
+    parallel_for_buckets(m_boundaries, m_alphabet_size, threads, [&](size_type i) {
+        PsiVector::Encoder encoder(t_block_size);
+        for (size_type k = runs.bucket_begin(i); k < runs.bucket_begin(i + 1); ++k)
         {
-            if (v_buf[start] == run.first + run.second)
-            {
-                run.second++;
-            } else {
-                encoder.addRun(run.first,run.second);
-                run = std::make_pair(v_buf[start], 1);
-            }
+            encoder.addRun(runs.value(k), runs.length(k));
         }
-        encoder.addRun(run.first, run.second);
         encoder.flush();
+        m_c[i].reset(new PsiVector(encoder, m_size));
+    });
+}
 
-        m_c[i] = new PsiVector(encoder, m_size);
+template <class t_boundaries, uint32_t t_block_size>
+template <uint8_t int_width>
+rlcsa_psi_vector<t_boundaries, t_block_size>::rlcsa_psi_vector(int_vector_buffer<int_width> &v_buf)
+{
+    rlcsa_psi_vector_builder<t_boundaries, t_block_size> builder(v_buf.size());
+    for (size_type i = 0; i < v_buf.size(); ++i)
+    {
+        builder.push_back(v_buf[i]);
+    }
+    rlcsa_psi_vector tmp(builder);
+    swap(tmp);
+}
+
+template <class t_boundaries, uint32_t t_block_size>
+rlcsa_psi_vector<t_boundaries, t_block_size>::rlcsa_psi_vector(rlcsa_psi_vector_builder<t_boundaries, t_block_size> &builder)
+{
+    if (builder.m_pos != builder.m_size)
+    {
+        throw std::logic_error("rlcsa_psi_vector: the builder got " + std::to_string(builder.m_pos) + " of " +
+                               std::to_string(builder.m_size) + " values");
+    }
+    if (builder.m_run_length > 0)
+    {
+        builder.close_bucket();
     }
+    builder.m_starts.push_back(builder.m_size);
+
+    clear();
+    m_size = builder.m_size;
+    m_alphabet_size = builder.m_buckets.size();
+    m_c.swap(builder.m_buckets);
+    m_boundaries = t_boundaries(builder.m_starts);
+
+    builder.m_size = builder.m_pos = builder.m_run_length = 0;
+    std::vector<uint64_t>().swap(builder.m_starts);
 }
 
-rlcsa_psi_vector::size_type rlcsa_psi_vector::serialize(std::ostream &out, structure_tree_node *v, std::string name) const
+template <class t_boundaries, uint32_t t_block_size>
+inline typename rlcsa_psi_vector<t_boundaries, t_block_size>::size_type rlcsa_psi_vector<t_boundaries, t_block_size>::serialize(std::ostream &out, structure_tree_node *v, std::string name) const
 {
     structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
     size_type written_bytes = 0;
     written_bytes += write_member(m_size, out, child, "size");
-    written_bytes += write_member(m_alphabet_size, out, child, "size");
-    size_type psi_vector_size = 0;
-    for (size_type i = 0; i < m_alphabet_size; ++i)
+    written_bytes += write_member(m_alphabet_size, out, child, "alphabet size");
+    size_type block_size = t_block_size;
+    written_bytes += write_member(block_size, out, child, "block size");
+
+    // RLEVector::writeTo takes an std::ofstream, so one is pointed at the
+    // buffer of out; the counting buffer in between sizes the vectors.
+    structure_tree_node *buckets = structure_tree::add_child(child, "buckets", "RLEVector");
+    rlcsa_psi_vector_detail::counting_streambuf counter(out.rdbuf());
+    std::ofstream file;
+    static_cast<std::ios &>(file).rdbuf(&counter);
+    for (const auto &bucket : m_c)
+    {
+        bucket->writeTo(file);
+    }
+    if (!file)
     {
-        psi_vector_size += m_c[i]->reportSize();
+        out.setstate(std::ios::badbit);
     }
-    bit_vector rlcsa(psi_vector_size*8,0);
-    written_bytes += rlcsa.serialize(out,child,"psi");
-    written_bytes += m_alphabet_marker.serialize(out, child, "alphabet marker");
+    structure_tree::add_size(buckets, counter.count());
+    written_bytes += counter.count();
+
+    written_bytes += m_boundaries.serialize(out, child, "alphabet marker");
     structure_tree::add_size(child, written_bytes);
     return written_bytes;
 }
 
-void rlcsa_psi_vector::load(std::istream &in)
+template <class t_boundaries, uint32_t t_block_size>
+inline void rlcsa_psi_vector<t_boundaries, t_block_size>::load(std::istream &in)
 {
     read_member(m_size, in);
     read_member(m_alphabet_size, in);
+    check_size(m_size);
+    // The RLEVectors are read as stored, so their block size must be the one of the type.
+    size_type block_size = 0;
+    read_member(block_size, in);
+    if (block_size != t_block_size)
+    {
+        throw std::runtime_error("rlcsa_psi_vector: the stream has block size " + std::to_string(block_size) +
+                                 ", the type " + std::to_string(t_block_size));
+    }
+
+    std::ifstream file;
+    static_cast<std::ios &>(file).rdbuf(in.rdbuf());
     m_c.resize(m_alphabet_size);
-    m_alphabet_marker.load(in);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    for (size_type i = 0; i < m_alphabet_size; ++i)
+    {
+        m_c[i].reset(new PsiVector(file));
+    }
+    if (!file)
+    {
+        in.setstate(std::ios::failbit);
+    }
+    m_boundaries.load(in);
 }
 
+//! Single pass construction of an rlcsa_psi_vector.
+/*! psi is appended value by value or run by run from a forward-only
+ *  source, e.g. a file read sequentially or the runs of the BWT. Only the
+ *  run in progress, the encoder of the current bucket, the finished
+ *  RLEVectors and the bucket starts are in memory, i.e. O(r) words for r
+ *  runs instead of the n words of psi. As in the other constructors, a
+ *  bucket ends where psi decreases.
+ *
+ *  Usage, as for sd_vector_builder:
+ *    rlcsa_psi_vector_builder<> builder(n);
+ *    for each run of psi: builder.add_run(value, length);
+ *    rlcsa_psi_vector<> psi(builder);
+ */
+template <class t_boundaries = small_alphabet_boundaries<>, uint32_t t_block_size = 32>
+class rlcsa_psi_vector_builder
+{
+    friend class rlcsa_psi_vector<t_boundaries, t_block_size>;
+
+  public:
+    typedef int_vector<>::size_type size_type;
+
+  private:
+    typedef CSA::RLEVector PsiVector;
+
+    size_type m_size = 0;       // length of psi
+    size_type m_pos = 0;        // number of values added
+    uint64_t m_run_value = 0;   // first value of the run in progress
+    size_type m_run_length = 0; // length of the run in progress, 0 before the first value
+    std::vector<uint64_t> m_starts;
+    std::vector<std::unique_ptr<PsiVector>> m_buckets;
+    std::unique_ptr<PsiVector::Encoder> m_encoder;
+
+    //! Encode the run in progress and finish the current bucket.
+    void close_bucket()
+    {
+        m_encoder->addRun(m_run_value, m_run_length);
+        m_encoder->flush();
+        m_buckets.emplace_back(new PsiVector(*m_encoder, m_size));
+        m_encoder.reset(new PsiVector::Encoder(t_block_size));
+    }
+
+  public:
+    //! \param n Length of psi.
+    explicit rlcsa_psi_vector_builder(size_type n) : m_size(n), m_encoder(new PsiVector::Encoder(t_block_size))
+    {
+        if (n > rlcsa_psi_vector<t_boundaries, t_block_size>::max_size())
+        {
+            throw std::length_error("rlcsa_psi_vector_builder: " + std::to_string(n) +
+                                    " elements exceed the positions of RLCSA, compile with -DMASSIVE_DATA_RLCSA");
+        }
+    }
+
+    rlcsa_psi_vector_builder(const rlcsa_psi_vector_builder &) = delete;
+    rlcsa_psi_vector_builder &operator=(const rlcsa_psi_vector_builder &) = delete;
+
+    //! Append the values value, value+1, ..., value+length-1.
+    void add_run(uint64_t value, size_type length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+        if (length > m_size - m_pos)
+        {
+            throw std::out_of_range("rlcsa_psi_vector_builder: more than " + std::to_string(m_size) + " values");
+        }
+        if (m_run_length > 0 && value == m_run_value + m_run_length)
+        {
+            m_run_length += length;
+        }
+        else
+        {
+            if (m_run_length == 0)
+            {
+                m_starts.push_back(0);
+            }
+            else if (value < m_run_value + m_run_length)
+            {
+                close_bucket();
+                m_starts.push_back(m_pos);
+            }
+            else
+            {
+                m_encoder->addRun(m_run_value, m_run_length);
+            }
+            m_run_value = value;
+            m_run_length = length;
+        }
+        m_pos += length;
+    }
+
+    //! Append the next value of psi.
+    void push_back(uint64_t value)
+    {
+        add_run(value, 1);
+    }
+
+    //! Number of values added so far.
+    size_type size() const
+    {
+        return m_pos;
+    }
+};
+
 } // end namespace sdsl
 #endif
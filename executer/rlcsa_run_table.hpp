@@ -0,0 +1,369 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2008 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file rlcsa_run_table.hpp
+   \brief rlcsa_run_table.hpp contains the sdsl::rlcsa_run_table class.
+   \author Simon Gog
+*/
+#ifndef RLCSA_RUN_TABLE
+#define RLCSA_RUN_TABLE
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <iterator>
+#include <algorithm>
+
+#include <sdsl/int_vector.hpp>
+#include <sdsl/memory_management.hpp>
+
+#include "rlcsa_psi_vector.hpp"
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Decoded run table of psi, mapped into memory instead of loaded.
+/*! This is not the RLEVector encoding of rlcsa_psi_vector but a separate
+ *  index written by store: every run of psi as (first position, first
+ *  value) in word aligned packed arrays, the first run of every bucket and
+ *  the run containing every block of positions. As the arrays are word
+ *  aligned, operator[] is answered directly from the mapping: the block
+ *  index points to the run containing a position and the value is
+ *  recovered from the run head. Nothing is decoded or copied on load and
+ *  the pages are shared between all processes mapping the same file.
+ *
+ *  The table takes about 2r log n bits for r runs, more than the
+ *  RLEVectors, see size_in_bytes().
+ */
+class rlcsa_run_table
+{
+  public:
+    typedef uint64_t value_type;
+    class const_iterator;
+    typedef const_iterator iterator;
+    typedef ptrdiff_t difference_type;
+    typedef int_vector<>::size_type size_type;
+
+  private:
+    //! Bit-packed array inside the mapping.
+    struct packed_array
+    {
+        const uint64_t *data = nullptr;
+        size_type size = 0;
+        uint8_t width = 0;
+
+        const uint64_t *map(const uint64_t *p)
+        {
+            size = p[0];
+            width = p[1];
+            data = p + 2;
+            return data + ((size * width + 63) >> 6);
+        }
+
+        value_type operator[](size_type i) const
+        {
+            return bits::read_int(data + ((i * width) >> 6), (i * width) & 0x3F, width);
+        }
+    };
+
+    std::string m_file;
+    int m_fd = -1;
+    void *m_mapped = nullptr;
+    size_type m_file_size = 0;
+
+    size_type m_size = 0;
+    size_type m_alphabet_size = 0;
+    size_type m_run_count = 0;
+    size_type m_block_shift = 0;
+    packed_array m_bucket_runs;
+    packed_array m_run_heads;
+    packed_array m_run_values;
+    packed_array m_block_index;
+
+    //! Run containing position i, by binary search between the runs at its block and at the next block.
+    /*! The block index has an entry past the last block, so b + 1 is in range for every i < size().
+     */
+    size_type find_run(size_type i) const
+    {
+        size_type b = i >> m_block_shift;
+        size_type lo = m_block_index[b];
+        size_type hi = m_block_index[b + 1];
+        while (lo < hi)
+        {
+            size_type mid = lo + (hi - lo + 1) / 2;
+            if (m_run_heads[mid] <= i)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid - 1;
+            }
+        }
+        return lo;
+    }
+
+    //! Write v word aligned as (length, width, words) so it can be mapped by packed_array.
+    static size_type write_packed(const int_vector<> &v, std::ostream &out)
+    {
+        size_type len = v.size();
+        size_type width = v.width();
+        size_type words = (v.bit_size() + 63) >> 6;
+        out.write((const char *)&len, sizeof(len));
+        out.write((const char *)&width, sizeof(width));
+        out.write((const char *)v.data(), words * sizeof(uint64_t));
+        return 2 * sizeof(size_type) + words * sizeof(uint64_t);
+    }
+
+  public:
+    rlcsa_run_table(const rlcsa_run_table &) = delete;
+    rlcsa_run_table &operator=(const rlcsa_run_table &) = delete;
+
+    //! Write the run table of v to file, for mapping by the constructor.
+    /*! The runs are read off the sequential iterator of v.
+     *  \return The number of written bytes.
+     */
+    template <class t_boundaries, uint32_t t_block_size>
+    static size_type store(const rlcsa_psi_vector<t_boundaries, t_block_size> &v, const std::string &file)
+    {
+        size_type n = v.size();
+        uint8_t width = bits::hi(std::max(n, (size_type)1)) + 1;
+
+        // Each bucket starts a new run, so the run heads alone determine
+        // the bucket of a position.
+        std::vector<size_type> heads, values;
+        int_vector<> bucket_runs(v.buckets() + 1, 0, width);
+        auto it = v.begin();
+        for (size_type c = 0, i = 0; c < v.buckets(); ++c)
+        {
+            bucket_runs[c] = heads.size();
+            value_type last = 0;
+            for (; i < v.bucket_start(c + 1); ++i, ++it)
+            {
+                value_type val = *it;
+                if (i == v.bucket_start(c) || val != last + 1)
+                {
+                    heads.push_back(i);
+                    values.push_back(val);
+                }
+                last = val;
+            }
+        }
+        size_type run_count = heads.size();
+        bucket_runs[v.buckets()] = run_count;
+
+        int_vector<> run_heads(run_count + 1, 0, width);
+        int_vector<> run_values(run_count, 0, width);
+        for (size_type k = 0; k < run_count; ++k)
+        {
+            run_heads[k] = heads[k];
+            run_values[k] = values[k];
+        }
+        run_heads[run_count] = n;
+
+        // Block index: entry b is the run containing position b << block_shift,
+        // with roughly one block per run on average. A position of the last
+        // block also reads the entry after its block, hence the sentinel.
+        size_type block_shift = run_count > 0 ? bits::hi(std::max((size_type)1, n / run_count)) : 0;
+        int_vector<> block_index((n >> block_shift) + 2, 0, bits::hi(std::max(run_count, (size_type)1)) + 1);
+        for (size_type b = 0, k = 0; b < block_index.size(); ++b)
+        {
+            while (k + 1 < run_count && run_heads[k + 1] <= (b << block_shift))
+                ++k;
+            block_index[b] = k;
+        }
+
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        size_type alphabet_size = v.buckets();
+        size_type written_bytes = 0;
+        written_bytes += write_member(n, out);
+        written_bytes += write_member(alphabet_size, out);
+        written_bytes += write_member(run_count, out);
+        written_bytes += write_member(block_shift, out);
+        written_bytes += write_packed(bucket_runs, out);
+        written_bytes += write_packed(run_heads, out);
+        written_bytes += write_packed(run_values, out);
+        written_bytes += write_packed(block_index, out);
+        if (!out)
+        {
+            throw std::runtime_error("rlcsa_run_table: write failed. " + file);
+        }
+        return written_bytes;
+    }
+
+    //! Map a file written by store.
+    explicit rlcsa_run_table(std::string file) : m_file(file)
+    {
+        m_file_size = util::file_size(m_file);
+        m_fd = memory_manager::open_file_for_mmap(m_file, std::ios_base::in);
+        if (m_fd == -1)
+        {
+            throw std::runtime_error("rlcsa_run_table: open file failed. " + m_file);
+        }
+        m_mapped = memory_manager::mmap_file(m_fd, m_file_size, std::ios_base::in);
+        if (m_mapped == nullptr)
+        {
+            memory_manager::close_file_for_mmap(m_fd);
+            throw std::runtime_error("rlcsa_run_table: mmap failed. " + m_file);
+        }
+        const uint64_t *p = (const uint64_t *)m_mapped;
+        m_size = p[0];
+        m_alphabet_size = p[1];
+        m_run_count = p[2];
+        m_block_shift = p[3];
+        p = m_bucket_runs.map(p + 4);
+        p = m_run_heads.map(p);
+        p = m_run_values.map(p);
+        m_block_index.map(p);
+    }
+
+    ~rlcsa_run_table()
+    {
+        if (m_mapped != nullptr)
+        {
+            memory_manager::mem_unmap(m_mapped, m_file_size);
+            memory_manager::close_file_for_mmap(m_fd);
+        }
+    }
+
+    //! The number of elements in the mapped vector.
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    //! Number of runs of the mapped vector.
+    size_type runs() const
+    {
+        return m_run_count;
+    }
+
+    //! Number of buckets.
+    size_type buckets() const
+    {
+        return m_alphabet_size;
+    }
+
+    //! First position of bucket c, bucket_start(buckets()) is size().
+    size_type bucket_start(size_type c) const
+    {
+        return m_run_heads[m_bucket_runs[c]];
+    }
+
+    //! Size of the mapped table in bytes, which is the file written by store.
+    size_type size_in_bytes() const
+    {
+        return m_file_size;
+    }
+
+    //! Iterator that points to the first element of the mapped vector.
+    const const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    //! Iterator that points to the position after the last element of the mapped vector.
+    const const_iterator end() const
+    {
+        return const_iterator(this, m_size);
+    }
+
+    //! operator[]
+    /*! \param i Index. \f$ i \in [0..size()-1]\f$.
+         */
+    value_type operator[](size_type i) const
+    {
+        size_type k = find_run(i);
+        return m_run_values[k] + (i - m_run_heads[k]);
+    }
+
+    //! Forward iterator walking the mapped run tables.
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef rlcsa_run_table::value_type value_type;
+        typedef rlcsa_run_table::difference_type difference_type;
+        typedef const value_type *pointer;
+        typedef value_type reference;
+
+      private:
+        const rlcsa_run_table *m_v = nullptr;
+        size_type m_i = 0;
+        size_type m_run = 0;
+        size_type m_run_end = 0;
+        value_type m_val = 0;
+
+        void seek()
+        {
+            if (m_i >= m_v->m_size)
+                return;
+            m_run = m_v->find_run(m_i);
+            m_run_end = m_v->m_run_heads[m_run + 1];
+            m_val = m_v->m_run_values[m_run] + (m_i - m_v->m_run_heads[m_run]);
+        }
+
+      public:
+        const_iterator() = default;
+
+        const_iterator(const rlcsa_run_table *v, size_type i) : m_v(v), m_i(i)
+        {
+            seek();
+        }
+
+        reference operator*() const
+        {
+            return m_val;
+        }
+
+        const_iterator &operator++()
+        {
+            if (++m_i < m_run_end)
+            {
+                ++m_val;
+            }
+            else if (m_i < m_v->m_size)
+            {
+                ++m_run;
+                m_run_end = m_v->m_run_heads[m_run + 1];
+                m_val = m_v->m_run_values[m_run];
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const const_iterator &it) const
+        {
+            return m_v == it.m_v && m_i == it.m_i;
+        }
+
+        bool operator!=(const const_iterator &it) const
+        {
+            return !(*this == it);
+        }
+    };
+};
+
+} // end namespace sdsl
+#endif
@@ -18,11 +18,25 @@
 #include <iostream>
 #include <chrono>
 #include <climits>
+#include <limits>
+#include <numeric>
 #include <random>
 #include <stack>
 
 #include "sdsl_psi_vector.hpp"
+#include "hybrid_bucket_vector.hpp"
 #include "rlcsa_psi_vector.hpp"
+#include "rlcsa_run_table.hpp"
+#include "psi_construction.hpp"
+#include "psi_merge.hpp"
+#include "memory_usage.hpp"
+#include "allocation_counter.hpp"
+#include "csa_psi.hpp"
+#include "concurrent_benchmark.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include "benchmark_runner.hpp"
+#include "parameter_sweep.hpp"
 
 
 #define x first
@@ -38,14 +52,50 @@ using ll = long long;
 template<uint32_t t_dens>
 using rl_vec = rl_vector<coder::elias_delta, sd_vector<>, t_dens> ;
 
+// Configurations of the parameter grids, see parameter_grid.
+template<class t_dens>
+struct rl_inc_config { typedef sdsl_psi_vector<rl_inc_vector<dac_vector_dp<>, sd_vector<>, t_dens::value>> type; };
+
+template<class t_levels, class t_dens>
+struct rl_inc_levels_config { typedef sdsl_psi_vector<rl_inc_vector<dac_vector_dp<rrr_vector<>, t_levels::value>, sd_vector<>, t_dens::value>> type; };
+
+template<class t_coder, class t_dens>
+struct rl_vector_config { typedef sdsl_psi_vector<rl_vector<t_coder, sd_vector<>, t_dens::value>> type; };
+
+template<class t_coder, class t_dens>
+struct enc_vector_config { typedef sdsl_psi_vector<enc_vector<t_coder, t_dens::value>> type; };
+
+template<class t_block_size>
+struct rlcsa_config { typedef rlcsa_psi_vector<small_alphabet_boundaries<>, t_block_size::value> type; };
+
+typedef type_list<coder::elias_delta, coder::elias_gamma, coder::fibonacci> grid_coders;
+
 using HighResClockTimepoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
 
 HighResClockTimepoint s, e;
 
 string test_file, temp_dir, test_id;
 
-const bool test = false;
+bool test = false;
 size_t max_iteration_index = 10000;
+size_t construction_threads = 1;
+uint64_t construction_ram_budget = 0;
+bool psi_streamed = false; // psi exceeds construction_ram_budget and is read from its cache file
+std::vector<size_t> batch_sizes = {1, 16, 64, 256, 1024};
+size_t pattern_length = 10;
+size_t pattern_count = 1000;
+size_t locate_pattern_count = 100;
+size_t extract_length = 64;
+size_t extract_count = 1000;
+std::vector<size_t> throughput_threads;
+size_t walk_steps = 64;
+std::vector<size_t> walk_chains = {1, 2, 4, 8};
+uint64_t seed = std::mt19937_64::default_seed;
+size_t bit_vector_length = 10000000;
+size_t bit_vector_runs = 100000;
+size_t merge_batch_percent = 10;
+std::vector<size_t> merge_base_eighths = {1, 2, 4, 8};
+perf_counters counters;
 
 inline HighResClockTimepoint time()
 {
@@ -70,223 +120,1825 @@ double microseconds()
     return elapsed_seconds.count() * MICRO;
 }
 
+double peak_rss_mib()
+{
+    return static_cast<double>(peak_rss_bytes()) / (1024.0 * 1024.0);
+}
 
-void construct_phi(cache_config &test_config, string &test_file)
+//! Print the RESULT line of a construction step of main, timed by s and e.
+/*! Every stage adds a field <stage>Time. The memory log of the step is
+ *  written to HTML/<phase>_<test_id>_memory.html.
+ */
+void constructionResult(const string &phase, const heap_sample &heap, const construction_stages &stages,
+                        const external_scans &scans = external_scans())
 {
+    cout << "RESULT"
+         << " Experiment=Construction"
+         << " Phase=" << phase
+         << " Benchmark=" << test_id
+         << " ConstructionTime=" << seconds()
+         << " ConstructionPeakRSS=" << peak_rss_mib()
+         << " ConstructionThreads=" << construction_threads
+         << " ConstructionRamBudget=" << construction_ram_budget / (1024 * 1024);
+    for (auto &stage : stages)
+    {
+        cout << " " << stage.first << "Time=" << stage.second;
+    }
+    if (scans.passes > 0)
+    {
+        cout << " ExternalPasses=" << scans.passes
+             << " ExternalIoMiB=" << scans.bytes / (1024.0 * 1024.0);
+    }
+    heap.print(cout, "Construction");
+    cout << endl;
+    std::ofstream memory_log("HTML/" + phase + "_" + test_id + "_memory.html");
+    memory_monitor::write_memory_log<HTML_FORMAT>(memory_log);
+}
+
+//! A streamed psi is not in memory, it is checked once by checkStreamedPsi instead.
+inline void testPsiValue(size_t idx, uint64_t enc_val, int_vector<>& psi) {
+    if(test && !psi_streamed) {
+        if(enc_val != psi[idx]) {
+            cout << "Failed to encrypt value!" << endl;
+            cout << "Idx=" << idx << " - Encrypted Value=" << enc_val << " - Real Value=" << psi[idx] << endl;
+            abort();
+        }
+    }
+}
 
+//! Compare vec front to back with the cached psi, which is read by an int_vector_buffer.
+template<class t_vector>
+void checkStreamedPsi(const t_vector &vec, cache_config &config)
+{
+    if (!test)
     {
-        cout << "Load text..." << endl;
-        int_vector<8> text;
-        load_vector_from_file(text, test_file, 1);
-        append_zero_symbol(text);
+        return;
+    }
+    int_vector_buffer<> psi_buf(cache_file_name(conf::KEY_PSI, config));
+    if (vec.size() != psi_buf.size())
+    {
+        cout << "Failed to encrypt psi!" << endl;
+        cout << "Size=" << vec.size() << " - Real Size=" << psi_buf.size() << endl;
+        abort();
+    }
+    auto it = vec.begin();
+    for (size_t i = 0; i < psi_buf.size(); ++i, ++it)
+    {
+        if (*it != psi_buf[i])
+        {
+            cout << "Failed to encrypt value!" << endl;
+            cout << "Idx=" << i << " - Encrypted Value=" << *it << " - Real Value=" << psi_buf[i] << endl;
+            abort();
+        }
+    }
+}
 
-        cout << "Construct Suffix Array..." << endl;
-        int_vector<> sa(text.size(), 0, bits::hi(text.size()) + 1);
-        algorithm::calculate_sa((const unsigned char *)text.data(), text.size(), sa);
+//! Print the percentiles and the maximum of hist in microseconds as RESULT fields.
+template<uint8_t t_sub_bits>
+void printLatency(const string &name, const latency_histogram<t_sub_bits> &hist)
+{
+    double us_per_tick = cycle_timer::ns_per_tick() / 1000.0;
+    cout << " " << name << "P50=" << hist.percentile(0.5) * us_per_tick
+         << " " << name << "P90=" << hist.percentile(0.9) * us_per_tick
+         << " " << name << "P99=" << hist.percentile(0.99) * us_per_tick
+         << " " << name << "P999=" << hist.percentile(0.999) * us_per_tick
+         << " " << name << "Max=" << hist.max() * us_per_tick;
+}
 
-        cout << "Construct Inverse Suffix Array..." << endl;
-        int_vector<> isa(text.size()+1, 0, bits::hi(text.size()) + 1);
-        for (size_t i = 0; i < text.size(); ++i)
+//! Random access throughput of vec on every thread count in throughput_threads.
+/*! All threads query the same read-only vec, each with its own
+ *  max_iteration_index random positions drawn before the clock starts.
+ */
+template<class t_vector>
+void throughputExperiment(string &vector_type, const t_vector &vec)
+{
+    for (size_t threads : throughput_threads)
+    {
+        std::vector<std::vector<uint64_t>> queries(threads, std::vector<uint64_t>(max_iteration_index));
+        for (size_t t = 0; t < threads; ++t)
         {
-            isa[sa[i]] = i;
+            std::mt19937_64 rng(seed + t);
+            std::uniform_int_distribution<uint64_t> distribution(0, vec.size() - 1);
+            for (auto &j : queries[t])
+            {
+                j = distribution(rng);
+            }
         }
-        isa[text.size()] = isa[0];
 
-        cout << "Construct Psi Array" << endl;
-        int_vector<> psi(text.size(), 0, bits::hi(text.size()) + 1);
-        for (size_t i = 0; i < text.size(); ++i) {
-            psi[i] = isa[sa[i] + 1];
+        // The sum of the values read is reported, so the reads cannot be elided.
+        thread_timings timings;
+        std::vector<uint64_t> sums(threads);
+        double wall_time = run_pinned_threads(threads, timings, [&](size_t t) {
+            uint64_t sum = 0;
+            for (uint64_t j : queries[t])
+            {
+                sum += vec[j];
+            }
+            sums[t] = sum;
+            return (uint64_t)queries[t].size();
+        });
+
+        double mean_latency = 0, max_latency = 0;
+        for (auto &timing : timings)
+        {
+            double latency = timing.seconds * MICRO / timing.queries;
+            mean_latency += latency / threads;
+            max_latency = std::max(max_latency, latency);
         }
-        util::bit_compress(psi);
-        store_to_cache(psi, conf::KEY_PSI, test_config);
+
+        cout << "RESULT"
+             << " Experiment=Throughput"
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " Threads=" << threads
+             << " QueriesPerSecond=" << threads * max_iteration_index / wall_time
+             << " MeanThreadLatency=" << mean_latency
+             << " MaxThreadLatency=" << max_latency
+             << " Checksum=" << std::accumulate(sums.begin(), sums.end(), (uint64_t)0)
+             << endl;
     }
 }
 
-void construct_bwt(cache_config &test_config, string &test_file)
+//! Dependent walks i -> step(i), for every chain count in walk_chains.
+/*! Every walk starts at a random position in [0, n) and takes walk_steps
+ *  steps, each indexed by the previous result, like extract and locate.
+ *  chains walks advance in lockstep: the CPU can overlap the misses of
+ *  different walks, but never two steps of the same walk. In test mode the
+ *  walks are repeated on the plain array reference.
+ */
+template<class t_step>
+void walkExperiment(const string &experiment, string &vector_type, uint64_t n, t_step step, const int_vector<> &reference)
 {
-
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> distribution(0, n - 1);
+    for (size_t chains : walk_chains)
     {
-        cout << "Load text..." << endl;
-        int_vector<8> text;
-        load_vector_from_file(text, test_file, 1);
-        append_zero_symbol(text);
-        store_to_cache(text, conf::KEY_TEXT, test_config);
+        size_t walks = std::max((size_t)1, max_iteration_index / (walk_steps * chains)) * chains;
+        std::vector<uint64_t> starts(walks);
+        for (auto &j : starts)
+        {
+            j = distribution(rng);
+        }
+
+        std::vector<uint64_t> pos(chains);
+        uint64_t sum = 0;
+        s = time();
+        for (size_t w = 0; w < walks; w += chains)
+        {
+            std::copy(starts.begin() + w, starts.begin() + w + chains, pos.begin());
+            for (size_t k = 0; k < walk_steps; ++k)
+            {
+                for (size_t c = 0; c < chains; ++c)
+                {
+                    pos[c] = step(pos[c]);
+                }
+            }
+            for (size_t c = 0; c < chains; ++c)
+            {
+                sum += pos[c];
+            }
+        }
+        e = time();
+        double time_per_step = microseconds() * 1000 / (walks * walk_steps);
 
-        cout << "Construct Suffix Array..." << endl;
-        int_vector<> sa(text.size(), 0, bits::hi(text.size()) + 1);
-        algorithm::calculate_sa((const unsigned char *)text.data(), text.size(), sa);
-        store_to_cache(sa, conf::KEY_SA, test_config);
+        if (test && !psi_streamed)
+        {
+            uint64_t expected = 0;
+            for (uint64_t j : starts)
+            {
+                for (size_t k = 0; k < walk_steps; ++k)
+                {
+                    j = reference[j];
+                }
+                expected += j;
+            }
+            if (sum != expected)
+            {
+                cout << experiment << " failed!" << endl;
+                cout << "Chains=" << chains << " - Sum=" << sum << " - Expected Sum=" << expected << endl;
+                abort();
+            }
+        }
 
-        cout << "Construct BWT..." << endl;
-        construct_bwt<8>(test_config);
+        cout << "RESULT"
+             << " Experiment=" << experiment
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " Chains=" << chains
+             << " Steps=" << walk_steps
+             << " NanosecondsPerStep=" << time_per_step
+             << endl;
     }
 }
 
-inline void testPsiValue(size_t idx, uint64_t enc_val, int_vector<>& psi) {
+//! Dependent walks i -> psi[i] on vec, see walkExperiment.
+template<class t_vector>
+void psiWalkExperiment(string &vector_type, const t_vector &vec, int_vector<> &psi)
+{
+    walkExperiment("PsiWalk", vector_type, vec.size(), [&vec](uint64_t i) -> uint64_t { return vec[i]; }, psi);
+}
+
+//! Baseline for range_search: two binary searches over operator[] on bucket c.
+template<class t_vector>
+std::pair<uint64_t, uint64_t> binarySearchRange(const t_vector &vec, size_t c, uint64_t lo, uint64_t hi)
+{
+    auto lower_bound = [&vec](uint64_t begin, uint64_t end, uint64_t x) {
+        while (begin < end)
+        {
+            uint64_t mid = begin + (end - begin) / 2;
+            if (vec[mid] < x)
+            {
+                begin = mid + 1;
+            }
+            else
+            {
+                end = mid;
+            }
+        }
+        return begin;
+    };
+    uint64_t first = lower_bound(vec.bucket_start(c), vec.bucket_start(c + 1), lo);
+    uint64_t last = lower_bound(first, vec.bucket_start(c + 1), hi + 1);
+    return std::make_pair(first, last);
+}
+
+inline void testRange(std::pair<uint64_t, uint64_t> range, std::pair<uint64_t, uint64_t> real_range) {
     if(test) {
-        if(enc_val != psi[idx]) {
-            cout << "Failed to encrypt value!" << endl;
-            cout << "Idx=" << idx << " - Encrypted Value=" << enc_val << " - Real Value=" << psi[idx] << endl;
+        if(range != real_range) {
+            cout << "Failed to search range!" << endl;
+            cout << "Range=[" << range.first << "," << range.second << ") - Real Range=[" << real_range.first << "," << real_range.second << ")" << endl;
+            abort();
+        }
+    }
+}
+
+inline size_t naiveCount(const string &pattern, int_vector<8> &text)
+{
+    size_t count = 0;
+    for (size_t i = 0; i + pattern.size() <= text.size(); ++i)
+    {
+        size_t k = 0;
+        while (k < pattern.size() && text[i + k] == (unsigned char)pattern[k])
+        {
+            ++k;
+        }
+        count += (k == pattern.size());
+    }
+    return count;
+}
+
+inline void testOccurrences(const string &pattern, size_t count, const std::vector<uint64_t> *occ, int_vector<8> &text) {
+    if(test) {
+        size_t real_count = naiveCount(pattern, text);
+        if(count != real_count || (occ != nullptr && occ->size() != real_count)) {
+            cout << "Failed to count pattern!" << endl;
+            cout << "Pattern=" << pattern << " - Count=" << count << " - Real Count=" << real_count << endl;
             abort();
         }
+        for (size_t i = 0; occ != nullptr && i < occ->size(); ++i) {
+            for (size_t k = 0; k < pattern.size(); ++k) {
+                if (text[(*occ)[i] + k] != (unsigned char)pattern[k]) {
+                    cout << "Failed to locate pattern!" << endl;
+                    cout << "Pattern=" << pattern << " - Position=" << (*occ)[i] << endl;
+                    abort();
+                }
+            }
+        }
+    }
+}
+
+//! Input the psi vector of PsiVectorExperiment is built from.
+enum class psi_source
+{
+    array,    //!< psi in memory
+    bwt_runs, //!< the runs of psi read off the cached BWT, in chunks with more than one thread
+    file      //!< the cached psi, read front to back by an int_vector_buffer
+};
+
+//! Only hybrid_bucket_vector estimates sizes, see below.
+template<class t_vector>
+void checkSizeEstimates(string &, const t_vector &, int_vector<> &)
+{
+}
+
+//! Compare the size estimates of hybrid_bucket_vector with the real sizes of every encoding of every bucket.
+/*! The estimates of buckets up to the calibration sample are exact, the
+ *  largest relative error on longer buckets is reported.
+ */
+template<class t_rl_vector, class t_enc_vector, uint32_t t_slack_percent, class t_boundaries>
+void checkSizeEstimates(string &vector_type, const sdsl_psi_vector<hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent>, t_boundaries> &vec, int_vector<> &psi)
+{
+    typedef hybrid_bucket_vector<t_rl_vector, t_enc_vector, t_slack_percent> hybrid_type;
+    double max_error = 0;
+    size_t estimated_buckets = 0;
+    for (size_t c = 0; c < vec.buckets(); ++c)
+    {
+        int_vector<> bucket(vec.bucket_start(c + 1) - vec.bucket_start(c), 0, psi.width());
+        for (size_t i = 0; i < bucket.size(); ++i)
+        {
+            bucket[i] = psi[vec.bucket_start(c) + i];
+        }
+        uint64_t estimate[3];
+        hybrid_type::estimate_bytes(bucket, estimate);
+        for (uint8_t k = hybrid_type::plain; k <= hybrid_type::delta; ++k)
+        {
+            uint64_t real = size_in_bytes(hybrid_type(bucket, static_cast<typename hybrid_type::kind_type>(k)));
+            if (bucket.size() <= hybrid_type::sample_size && estimate[k] != real)
+            {
+                cout << "Failed to estimate the size!" << endl;
+                cout << "Bucket=" << c << " - Kind=" << (int)k << " - Estimate=" << estimate[k] << " - Real Size=" << real << endl;
+                abort();
+            }
+            max_error = std::max(max_error, std::abs((double)estimate[k] - (double)real) / real);
+        }
+        estimated_buckets += bucket.size() > hybrid_type::sample_size;
     }
+    cout << "RESULT"
+         << " Experiment=SizeEstimate"
+         << " Vector=" << vector_type
+         << " Benchmark=" << test_id
+         << " EstimatedBuckets=" << estimated_buckets
+         << " MaxEstimateErrorPercent=" << 100 * max_error
+         << endl;
 }
 
 template<class t_vector>
 class PsiVectorExperiment {
   public:
-    PsiVectorExperiment(string &vector_type, int_vector<> &psi)
+    //! config is the cache of the BWT and psi, needed unless source is psi_source::array.
+    /*! A streamed psi is empty, the vector is then built from the cached psi.
+     */
+    PsiVectorExperiment(string &vector_type, int_vector<> &psi, psi_source source = psi_source::array, cache_config *config = nullptr)
     {
+        if (psi_streamed && source == psi_source::array)
+        {
+            source = psi_source::file;
+        }
+        reset_peak_rss();
+        heap_monitor::start();
+        counters.start();
         s = time();
-        t_vector compressed_vec(psi);
+        t_vector compressed_vec;
+        if (source == psi_source::bwt_runs && construction_threads > 1)
+        {
+            psi_runs runs;
+            {
+                int_vector<8> bwt;
+                load_from_cache(bwt, conf::KEY_BWT, *config);
+                psi_runs tmp(bwt, construction_threads);
+                std::swap(runs, tmp);
+            }
+            t_vector tmp_vec(runs, construction_threads);
+            compressed_vec.swap(tmp_vec);
+        }
+        else if (source == psi_source::bwt_runs)
+        {
+            int_vector_buffer<8> bwt_buf(cache_file_name(conf::KEY_BWT, *config));
+            psi_runs runs(bwt_buf);
+            t_vector tmp_vec(runs, construction_threads);
+            compressed_vec.swap(tmp_vec);
+        }
+        else if (source == psi_source::file)
+        {
+            int_vector_buffer<> psi_buf(cache_file_name(conf::KEY_PSI, *config));
+            t_vector tmp_vec(psi_buf);
+            compressed_vec.swap(tmp_vec);
+        }
+        else
+        {
+            t_vector tmp_vec(psi, construction_threads);
+            compressed_vec.swap(tmp_vec);
+        }
         e = time();
+        perf_sample construction_counters = counters.stop();
+        heap_sample construction_heap = heap_monitor::stop();
         double construction_time = seconds();
-        double space_bits_per_element = 8.0 * (static_cast<double>(size_in_bytes(compressed_vec)) / static_cast<double>(psi.size()));
+        double construction_peak_rss = peak_rss_mib();
+        size_t n = compressed_vec.size();
+        double space_bits_per_element = 8.0 * (static_cast<double>(size_in_bytes(compressed_vec)) / static_cast<double>(n));
 
         //std::cout << space_bits_per_element << std::endl;
         write_structure<HTML_FORMAT>(compressed_vec, "HTML/" + vector_type + "_" + test_id + ".html");
+        if (psi_streamed)
+        {
+            checkStreamedPsi(compressed_vec, *config);
+        }
+        else if (test)
+        {
+            checkSizeEstimates(vector_type, compressed_vec, psi);
+        }
 
-        std::mt19937_64 rng;
-        std::uniform_int_distribution<uint64_t> distribution(0, psi.size());
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, n - 1);
         auto dice = bind(distribution, rng);
 
+        counters.start();
         s = time();
-        for (int i = 0; i < max_iteration_index; ++i)
+        for (size_t i = 0; i < max_iteration_index; ++i)
         {
             size_t j = dice();
             volatile uint64_t psi_val = compressed_vec[j];
             testPsiValue(j, psi_val, psi);
         }
         e = time();
+        perf_sample random_access_counters = counters.stop();
         double random_access_time_per_element = microseconds() / max_iteration_index;
+        latency_histogram<> random_access_latency;
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            uint64_t start = cycle_timer::now();
+            volatile uint64_t psi_val = compressed_vec[j];
+            random_access_latency.add(cycle_timer::elapsed(start));
+        }
+        counters.start();
         s = time();
-        for (int i = 0; i < max_iteration_index; ++i)
+        auto it = compressed_vec.begin();
+        for (size_t i = 0; i < max_iteration_index; ++i, ++it)
         {
-            volatile uint64_t psi_val = compressed_vec[i];
+            volatile uint64_t psi_val = *it;
             testPsiValue(i, psi_val, psi);
         }
         e = time();
+        perf_sample sequential_access_counters = counters.stop();
         double sequential_acces_time_per_element = microseconds() / max_iteration_index;
 
+        std::vector<uint64_t> batch_idx(max_iteration_index), batch_out(max_iteration_index), batch_order(max_iteration_index);
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            batch_idx[i] = dice();
+        }
+        std::vector<double> batch_access_time_per_element;
+        for (size_t batch_size : batch_sizes)
+        {
+            s = time();
+            for (size_t i = 0; i < max_iteration_index; i += batch_size)
+            {
+                size_t n = std::min(batch_size, max_iteration_index - i);
+                compressed_vec.access_batch(batch_idx.data() + i, n, batch_out.data() + i, batch_order.data());
+            }
+            e = time();
+            batch_access_time_per_element.push_back(microseconds() / max_iteration_index);
+            for (size_t i = 0; i < max_iteration_index; ++i)
+            {
+                testPsiValue(batch_idx[i], batch_out[i], psi);
+            }
+        }
+
+        // Range queries [psi[j], psi[j+k]] in the bucket of a random position j, k < 64.
+        std::vector<uint64_t> range_bucket(max_iteration_index), range_lo(max_iteration_index), range_hi(max_iteration_index);
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            range_bucket[i] = compressed_vec.bucket(j);
+            range_lo[i] = compressed_vec[j];
+            range_hi[i] = compressed_vec[std::min(j + dice() % 64, compressed_vec.bucket_start(range_bucket[i] + 1) - 1)];
+        }
+        std::vector<std::pair<uint64_t, uint64_t>> ranges(max_iteration_index);
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            ranges[i] = compressed_vec.range_search(range_bucket[i], range_lo[i], range_hi[i]);
+        }
+        e = time();
+        double range_search_time_per_query = microseconds() / max_iteration_index;
+        std::vector<std::pair<uint64_t, uint64_t>> baseline_ranges(max_iteration_index);
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            baseline_ranges[i] = binarySearchRange(compressed_vec, range_bucket[i], range_lo[i], range_hi[i]);
+        }
+        e = time();
+        double binary_search_range_time_per_query = microseconds() / max_iteration_index;
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            testRange(ranges[i], baseline_ranges[i]);
+        }
+        // Bounds at and past the end of psi select the whole bucket or nothing.
+        for (size_t i = 0; test && i < max_iteration_index; ++i)
+        {
+            uint64_t c = range_bucket[i];
+            std::pair<uint64_t, uint64_t> bucket(compressed_vec.bucket_start(c), compressed_vec.bucket_start(c + 1));
+            testRange(compressed_vec.range_search(c, 0, n + i), bucket);
+            testRange(compressed_vec.range_search(c, n + i, n + i + 1), std::make_pair(bucket.second, bucket.second));
+            testRange(compressed_vec.range_search(c, range_lo[i], std::numeric_limits<uint64_t>::max()),
+                      std::make_pair(ranges[i].first, bucket.second));
+        }
+
         cout << "RESULT"
              << " Vector=" << vector_type
              << " Benchmark=" << test_id
              << " ConstructionTime=" << construction_time
+             << " ConstructionPeakRSS=" << construction_peak_rss
+             << " ConstructionThreads=" << construction_threads
              << " SpaceBitsPerElement=" << space_bits_per_element
-             << " RandomAccessTimePerElement=" << random_access_time_per_element
-             << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element
-             << endl;
+             << " RandomAccessTimePerElement=" << random_access_time_per_element;
+        printLatency("RandomAccessLatency", random_access_latency);
+        cout << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element;
+        for (size_t i = 0; i < batch_sizes.size(); ++i)
+        {
+            cout << " BatchAccessTimePerElement_" << batch_sizes[i] << "=" << batch_access_time_per_element[i];
+        }
+        cout << " RangeSearchTimePerQuery=" << range_search_time_per_query
+             << " BinarySearchRangeTimePerQuery=" << binary_search_range_time_per_query;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", n);
+        random_access_counters.print(cout, "RandomAccess", max_iteration_index);
+        sequential_access_counters.print(cout, "SequentialAccess", max_iteration_index);
+        cout << endl;
+
+        psiWalkExperiment(vector_type, compressed_vec, psi);
+        throughputExperiment(vector_type, compressed_vec);
   }
 };
 
-template <class t_wt>
-class BWTExperiment
+//! pattern_count patterns of length pattern_length, drawn from text without the sentinel.
+std::vector<string> samplePatterns(const int_vector<8> &text)
 {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> distribution(0, text.size() - 1 - pattern_length);
+    auto dice = bind(distribution, rng);
+    std::vector<string> patterns(pattern_count);
+    for (auto &pattern : patterns)
+    {
+        size_t j = dice();
+        for (size_t k = 0; k < pattern_length; ++k)
+        {
+            pattern.push_back(text[j + k]);
+        }
+    }
+    return patterns;
+}
 
-typedef typename wt_alphabet_trait<t_wt>::type alphabet_type;
-
+template <class t_psi_vector>
+class PatternExperiment
+{
   public:
-    BWTExperiment(string &vector_type, cache_config &config)
+    PatternExperiment(string &vector_type, int_vector<8> &text, cache_config &config)
     {
+        reset_peak_rss();
+        heap_monitor::start();
+        counters.start();
         s = time();
-        int_vector_buffer<alphabet_type::int_width> bwt_buf(cache_file_name(key_trait<alphabet_type::int_width>::KEY_BWT, config));
-        size_t n = bwt_buf.size();
-        t_wt wt(bwt_buf,n);
+        csa_psi<t_psi_vector> csa(config, construction_threads);
         e = time();
+        perf_sample construction_counters = counters.stop();
+        heap_sample construction_heap = heap_monitor::stop();
         double construction_time = seconds();
-        double space_bits_per_element = 8.0 * (static_cast<double>(size_in_bytes(wt)) / static_cast<double>(n));
-
-        write_structure<HTML_FORMAT>(wt, "HTML/" + vector_type + "_" + test_id + ".html");
+        double construction_peak_rss = peak_rss_mib();
+        double space_bits_per_symbol = 8.0 * (static_cast<double>(size_in_bytes(csa)) / static_cast<double>(csa.size()));
 
-        std::mt19937_64 rng;
-        std::uniform_int_distribution<uint64_t> distribution(0, bwt_buf.size());
-        auto dice = bind(distribution, rng);
+        std::vector<string> patterns = samplePatterns(text);
 
+        counters.start();
         s = time();
-        for (int i = 0; i < max_iteration_index; ++i)
+        for (auto &pattern : patterns)
         {
-            size_t j = dice();
-            volatile uint64_t bwt_val = wt[j];
+            size_t count = csa.count(pattern);
+            testOccurrences(pattern, count, nullptr, text);
         }
         e = time();
-        double random_access_time_per_element = microseconds() / max_iteration_index;
+        perf_sample count_counters = counters.stop();
+        double count_patterns_per_second = patterns.size() / seconds();
+        latency_histogram<> count_latency;
+        size_t counted_occurrences = 0;
+        for (auto &pattern : patterns)
+        {
+            uint64_t start = cycle_timer::now();
+            counted_occurrences += csa.count(pattern);
+            count_latency.add(cycle_timer::elapsed(start));
+        }
+
+        size_t located_patterns = std::min(locate_pattern_count, patterns.size());
+        size_t occurrences = 0;
         s = time();
-        for (int i = 0; i < max_iteration_index; ++i)
+        for (size_t i = 0; i < located_patterns; ++i)
         {
-            volatile uint64_t bwt_val = wt[i];
+            std::vector<uint64_t> occ = csa.locate(patterns[i]);
+            occurrences += occ.size();
+            testOccurrences(patterns[i], occ.size(), &occ, text);
         }
         e = time();
-        double sequential_acces_time_per_element = microseconds() / max_iteration_index;
+        double locate_patterns_per_second = located_patterns / seconds();
+        double locate_occurrences_per_second = occurrences / seconds();
 
         cout << "RESULT"
+             << " Experiment=Pattern"
              << " Vector=" << vector_type
              << " Benchmark=" << test_id
              << " ConstructionTime=" << construction_time
-             << " SpaceBitsPerElement=" << space_bits_per_element
-             << " RandomAccessTimePerElement=" << random_access_time_per_element
-             << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element
-             << endl;
+             << " ConstructionPeakRSS=" << construction_peak_rss
+             << " SpaceBitsPerSymbol=" << space_bits_per_symbol
+             << " PatternLength=" << pattern_length
+             << " CountPatternsPerSecond=" << count_patterns_per_second;
+        printLatency("CountLatency", count_latency);
+        cout << " CountedOccurrences=" << counted_occurrences;
+        cout << " LocatePatternsPerSecond=" << locate_patterns_per_second
+             << " LocateOccurrencesPerSecond=" << locate_occurrences_per_second;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", csa.size());
+        count_counters.print(cout, "Count", patterns.size());
+        cout << endl;
     }
 };
 
-int main(int argc, char *argv[])
+template <class t_psi_vector, uint32_t t_sample_rate>
+class SampleRateExperiment
 {
+  public:
+    SampleRateExperiment(string &vector_type, int_vector<8> &text, cache_config &config)
+    {
+        s = time();
+        csa_psi<t_psi_vector, t_sample_rate, t_sample_rate> csa(config, construction_threads);
+        e = time();
+        double construction_time = seconds();
+        double space_bits_per_symbol = 8.0 * (static_cast<double>(size_in_bytes(csa)) / static_cast<double>(csa.size()));
 
-    test_file = argv[1];
-    temp_dir = argv[2];
-    test_id = test_file.substr(test_file.find_last_of("/\\") + 1);
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, csa.size() - 1);
+        auto dice = bind(distribution, rng);
 
-    cache_config test_config = cache_config(false, temp_dir, test_id);
+        s = time();
+        size_t extracted = 0;
+        for (size_t i = 0; i < extract_count; ++i)
+        {
+            size_t t = dice();
+            string snippet = csa.extract(t, extract_length);
+            extracted += snippet.size();
+            if (test) {
+                for (size_t k = 0; k < snippet.size(); ++k) {
+                    if ((unsigned char)snippet[k] != text[t + k]) {
+                        cout << "Failed to extract text!" << endl;
+                        cout << "Position=" << t + k << " - Extracted=" << (int)(unsigned char)snippet[k] << " - Real=" << text[t + k] << endl;
+                        abort();
+                    }
+                }
+            }
+        }
+        e = time();
+        double extract_chars_per_second = extracted / seconds();
 
-    string psi_file = cache_file_name(conf::KEY_PSI, test_config);
-    int_vector<> psi;
-    if (!load_from_file(psi, psi_file))
-    {
-        construct_phi(test_config, test_file);
-        load_from_file(psi, psi_file);
-    }
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t sa_val = csa.sa(j);
+            if (test && csa.isa(sa_val) != j) {
+                cout << "Failed to locate suffix!" << endl;
+                cout << "Idx=" << j << " - SA=" << sa_val << endl;
+                abort();
+            }
+        }
+        e = time();
+        double locate_time_per_occurrence = microseconds() / max_iteration_index;
 
-    if (!cache_file_exists(conf::KEY_BWT, test_config))
-    {
-        construct_bwt(test_config, test_file);
+        cout << "RESULT"
+             << " Experiment=SampleRate"
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " SampleRate=" << t_sample_rate
+             << " ConstructionTime=" << construction_time
+             << " SpaceBitsPerSymbol=" << space_bits_per_symbol
+             << " ExtractCharsPerSecond=" << extract_chars_per_second
+             << " LocateTimePerOccurrence=" << locate_time_per_occurrence
+             << endl;
     }
+};
 
+//! Run SampleRateExperiment for every rate in t_sample_rates.
+template <class t_psi_vector, uint32_t... t_sample_rates>
+void sampleRateSweep(string &vector_type, int_vector<8> &text, cache_config &config)
+{
+    int sweep[] = {(SampleRateExperiment<t_psi_vector, t_sample_rates>(vector_type, text, config), 0)...};
+    (void)sweep;
+}
 
+//! psi of text in memory, psi[i] = ISA[SA[i]+1] with the last suffix wrapping around to ISA[0].
+int_vector<> psiOfText(const int_vector<8> &text)
+{
+    int_vector<> sa(text.size(), 0, bits::hi(text.size()) + 1);
+    algorithm::calculate_sa((const unsigned char *)text.data(), text.size(), sa);
+    int_vector<> isa(text.size(), 0, bits::hi(text.size()) + 1);
+    for (size_t i = 0; i < text.size(); ++i)
     {
-        string algo = "rlcsa_vector";
-        PsiVectorExperiment<rlcsa_psi_vector> experiment(algo, psi);
+        isa[sa[i]] = i;
     }
-
+    int_vector<> psi(text.size(), 0, bits::hi(text.size()) + 1);
+    for (size_t i = 0; i < text.size(); ++i)
     {
-        string algo = "rl_bitenc_vector";
-        PsiVectorExperiment<sdsl_psi_vector<rl_bitenc_vector>> experiment(algo, psi);
+        psi[i] = isa[sa[i] + 1 < text.size() ? sa[i] + 1 : 0];
     }
+    return psi;
+}
 
-
+//! text[begin, end) followed by the terminator 0.
+int_vector<8> terminatedText(const int_vector<8> &text, size_t begin, size_t end)
+{
+    int_vector<8> part(end - begin + 1, 0);
+    for (size_t i = begin; i < end; ++i)
     {
-        string algo = "rl_vector_16";
-        PsiVectorExperiment<sdsl_psi_vector<rl_vec<16>>> experiment(algo, psi);
+        part[i - begin] = text[i];
     }
+    return part;
+}
 
+//! Merge of a base index with a new batch against the full rebuild.
+/*! The last merge_batch_percent of the text is the batch, the bases are
+ *  growing prefixes of the rest. The merge suffix sorts only the batch and
+ *  backward searches it on the base psi vector, the rebuild suffix sorts
+ *  base and batch as one text and encodes its psi. Both timings include
+ *  the encoding of the resulting psi vector, the base vector is built
+ *  before.
+ */
+template <class t_vector>
+class MergeExperiment
+{
+  public:
+    MergeExperiment(string &vector_type, int_vector<8> &text)
     {
-        string algo = "rl_inc_vector";
-        PsiVectorExperiment<sdsl_psi_vector<rl_inc_vector<dac_vector_dp<>, sd_vector<>, 8>>> experiment(algo, psi);
+        size_t n = text.size() - 1; // without the terminator
+        size_t batch_length = std::max((size_t)1, n * merge_batch_percent / 100);
+        if (batch_length >= n)
+        {
+            throw std::invalid_argument("--merge-batch leaves no base text");
+        }
+        int_vector<8> batch = terminatedText(text, n - batch_length, n);
+        int_vector<64> C_batch(257, 0);
+        add_symbol_counts(C_batch, batch);
+
+        for (size_t eighths : merge_base_eighths)
+        {
+            size_t base_length = std::max((size_t)1, (n - batch_length) * eighths / 8);
+            int_vector<64> C_base(257, 0);
+            t_vector base_vec;
+            {
+                int_vector<8> base = terminatedText(text, 0, base_length);
+                add_symbol_counts(C_base, base);
+                t_vector tmp_vec(psiOfText(base), construction_threads);
+                base_vec.swap(tmp_vec);
+            }
+
+            s = time();
+            t_vector merged_vec;
+            merge_psi_vectors(base_vec, C_base, batch, merged_vec, construction_threads);
+            e = time();
+            double merge_time = seconds();
+
+            s = time();
+            t_vector rebuilt_vec;
+            {
+                int_vector<8> full = terminatedText(text, 0, base_length + batch_length);
+                for (size_t i = 0; i < batch_length; ++i)
+                {
+                    full[base_length + i] = batch[i];
+                }
+                t_vector tmp_vec(psiOfText(full), construction_threads);
+                rebuilt_vec.swap(tmp_vec);
+            }
+            e = time();
+            double rebuild_time = seconds();
+
+            if (test)
+            {
+                checkMerge(merged_vec, text, base_length, batch);
+            }
+
+            cout << "RESULT"
+                 << " Experiment=Merge"
+                 << " Vector=" << vector_type
+                 << " Benchmark=" << test_id
+                 << " BaseLength=" << base_length
+                 << " BatchLength=" << batch_length
+                 << " MergeTime=" << merge_time
+                 << " RebuildTime=" << rebuild_time
+                 << " MergedSpaceBitsPerElement=" << 8.0 * size_in_bytes(merged_vec) / merged_vec.size()
+                 << " RebuiltSpaceBitsPerElement=" << 8.0 * size_in_bytes(rebuilt_vec) / rebuilt_vec.size()
+                 << endl;
+        }
     }
 
+  private:
+    //! Compare with the psi of base+1 0 batch+1 1, whose unique terminators order the suffixes as the merge does.
+    /*! The shift needs a free symbol, so texts containing 255 are not
+     *  checked, which is reported.
+     */
+    void checkMerge(const t_vector &merged_vec, const int_vector<8> &text, size_t base_length, const int_vector<8> &batch)
     {
-        string algo = "wt_rlmn_bwt_vector";
-        BWTExperiment<wt_rlmn<>> experiment(algo, test_config);
+        int_vector<8> shifted(merged_vec.size(), 0);
+        for (size_t i = 0; i < base_length; ++i)
+        {
+            if (text[i] == 255)
+            {
+                cout << "Skipped the merge check: the text contains the symbol 255." << endl;
+                return;
+            }
+            shifted[i] = text[i] + 1;
+        }
+        for (size_t i = 0; i + 1 < batch.size(); ++i)
+        {
+            if (batch[i] == 255)
+            {
+                cout << "Skipped the merge check: the text contains the symbol 255." << endl;
+                return;
+            }
+            shifted[base_length + 1 + i] = batch[i] + 1;
+        }
+        shifted[merged_vec.size() - 1] = 1;
+        int_vector<> psi = psiOfText(shifted);
+        for (size_t i = 0; i < psi.size(); ++i)
+        {
+            testPsiValue(i, merged_vec[i], psi);
+        }
     }
+};
 
+template <class t_vector, class t_mapper>
+class MappedPsiVectorExperiment
+{
+  public:
+    MappedPsiVectorExperiment(string &vector_type, int_vector<> &psi, cache_config &config)
     {
-        string algo = "wt_rl_huff_bwt_vector";
-        BWTExperiment<wt_huff<rl_bit_vector<>>> experiment(algo, test_config);
-    }
+        string file = cache_file_name("psi_" + vector_type, config);
+        {
+            t_vector compressed_vec;
+            build(compressed_vec, psi, config);
+            t_mapper::store(compressed_vec, file);
+        }
+
+        reset_peak_rss();
+        heap_monitor::start();
+        counters.start();
+        s = time();
+        t_mapper mapped_vec(file);
+        e = time();
+        perf_sample construction_counters = counters.stop();
+        heap_sample construction_heap = heap_monitor::stop();
+        double load_time = seconds();
+        double load_peak_rss = peak_rss_mib();
+        size_t n = mapped_vec.size();
+        double space_bits_per_element = 8.0 * (static_cast<double>(mapped_vec.size_in_bytes()) / static_cast<double>(n));
 
+        if (test)
+        {
+            checkMapped(mapped_vec, psi, config);
+        }
 
-    {
-        string algo = "enc_vector";
-        PsiVectorExperiment < sdsl_psi_vector<enc_vector<>>> experiment(algo, psi);
-    }
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, n - 1);
+        auto dice = bind(distribution, rng);
 
-}
\ No newline at end of file
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t psi_val = mapped_vec[j];
+            testPsiValue(j, psi_val, psi);
+        }
+        e = time();
+        perf_sample random_access_counters = counters.stop();
+        double random_access_time_per_element = microseconds() / max_iteration_index;
+        latency_histogram<> random_access_latency;
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            uint64_t start = cycle_timer::now();
+            volatile uint64_t psi_val = mapped_vec[j];
+            random_access_latency.add(cycle_timer::elapsed(start));
+        }
+        counters.start();
+        s = time();
+        auto it = mapped_vec.begin();
+        for (size_t i = 0; i < max_iteration_index; ++i, ++it)
+        {
+            volatile uint64_t psi_val = *it;
+            testPsiValue(i, psi_val, psi);
+        }
+        e = time();
+        perf_sample sequential_access_counters = counters.stop();
+        double sequential_acces_time_per_element = microseconds() / max_iteration_index;
+
+        cout << "RESULT"
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " ConstructionTime=" << load_time
+             << " ConstructionPeakRSS=" << load_peak_rss
+             << " SpaceBitsPerElement=" << space_bits_per_element
+             << " RandomAccessTimePerElement=" << random_access_time_per_element;
+        printLatency("RandomAccessLatency", random_access_latency);
+        cout << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", n);
+        random_access_counters.print(cout, "RandomAccess", max_iteration_index);
+        sequential_access_counters.print(cout, "SequentialAccess", max_iteration_index);
+        cout << endl;
+
+        psiWalkExperiment(vector_type, mapped_vec, psi);
+    }
+
+  private:
+    //! Build vec from psi, or from the cached psi if psi is streamed.
+    static void build(t_vector &vec, int_vector<> &psi, cache_config &config)
+    {
+        if (psi_streamed)
+        {
+            int_vector_buffer<> psi_buf(cache_file_name(conf::KEY_PSI, config));
+            t_vector tmp_vec(psi_buf);
+            vec.swap(tmp_vec);
+        }
+        else
+        {
+            t_vector tmp_vec(psi);
+            vec.swap(tmp_vec);
+        }
+    }
+
+    //! Compare operator[] of the mapping with operator[] of the vector at every position, the last block included.
+    void checkMapped(const t_mapper &mapped_vec, int_vector<> &psi, cache_config &config)
+    {
+        if (psi_streamed)
+        {
+            checkStreamedPsi(mapped_vec, config);
+        }
+        t_vector compressed_vec;
+        build(compressed_vec, psi, config);
+        if (mapped_vec.size() != compressed_vec.size())
+        {
+            cout << "Failed to map the vector!" << endl;
+            cout << "Mapped Size=" << mapped_vec.size() << " - Real Size=" << compressed_vec.size() << endl;
+            abort();
+        }
+        for (size_t i = 0; i < compressed_vec.size(); ++i)
+        {
+            if (mapped_vec[i] != compressed_vec[i])
+            {
+                cout << "Failed to map the vector!" << endl;
+                cout << "Idx=" << i << " - Mapped Value=" << mapped_vec[i] << " - Real Value=" << compressed_vec[i] << endl;
+                abort();
+            }
+        }
+    }
+};
+
+//! LF(i) = C[c] + rank(i, c) for c = bwt[i], the inverse of psi, on the wavelet tree wt of the BWT.
+template <class t_wt>
+inline uint64_t lfStep(const t_wt &wt, const int_vector<64> &C, uint64_t i)
+{
+    auto r = wt.inverse_select(i);
+    return C[r.second] + r.first;
+}
+
+//! Count the occurrences of pattern by backward search on the wavelet tree wt of the BWT.
+/*! Two ranks per symbol, the BWT counterpart of csa_psi::count.
+ */
+template <class t_wt>
+uint64_t backwardSearchCount(const t_wt &wt, const int_vector<64> &C, const string &pattern)
+{
+    uint64_t lo = 0, hi = wt.size();
+    for (size_t k = pattern.size(); k-- > 0 && lo < hi;)
+    {
+        unsigned char c = pattern[k];
+        lo = C[c] + wt.rank(lo, c);
+        hi = C[c] + wt.rank(hi, c);
+    }
+    return hi - lo;
+}
+
+//! Access, rank, select, LF and backward search on a wavelet tree of the BWT.
+/*! The LF walks and the counts print Experiment=LFWalk and
+ *  Experiment=Pattern lines with the columns of the psi walks and of
+ *  PatternExperiment, so both indexes compare directly. text is the text
+ *  of the BWT, psi checks LF in test mode. The wavelet tree is built in
+ *  one thread: wt_rlmn and wt_huff only construct from a stream and keep
+ *  their bit vectors private, so a level-wise parallel build would
+ *  benchmark a different structure. Only the BWT itself, see
+ *  construct_bwt_in_memory, is built with construction_threads.
+ */
+template <class t_wt>
+class BWTExperiment
+{
+
+typedef typename wt_alphabet_trait<t_wt>::type alphabet_type;
+
+  public:
+    BWTExperiment(string &vector_type, cache_config &config, int_vector<8> &text, int_vector<> &psi)
+    {
+        reset_peak_rss();
+        heap_monitor::start();
+        counters.start();
+        s = time();
+        int_vector_buffer<alphabet_type::int_width> bwt_buf(cache_file_name(key_trait<alphabet_type::int_width>::KEY_BWT, config));
+        size_t n = bwt_buf.size();
+        t_wt wt(bwt_buf,n);
+        e = time();
+        perf_sample construction_counters = counters.stop();
+        heap_sample construction_heap = heap_monitor::stop();
+        double construction_time = seconds();
+        double construction_peak_rss = peak_rss_mib();
+        double space_bits_per_element = 8.0 * (static_cast<double>(size_in_bytes(wt)) / static_cast<double>(n));
+
+        write_structure<HTML_FORMAT>(wt, "HTML/" + vector_type + "_" + test_id + ".html");
+
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, bwt_buf.size() - 1);
+        auto dice = bind(distribution, rng);
+
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t bwt_val = wt[j];
+        }
+        e = time();
+        perf_sample random_access_counters = counters.stop();
+        double random_access_time_per_element = microseconds() / max_iteration_index;
+        latency_histogram<> random_access_latency;
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            uint64_t start = cycle_timer::now();
+            volatile uint64_t bwt_val = wt[j];
+            random_access_latency.add(cycle_timer::elapsed(start));
+        }
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            volatile uint64_t bwt_val = wt[i];
+        }
+        e = time();
+        perf_sample sequential_access_counters = counters.stop();
+        double sequential_acces_time_per_element = microseconds() / max_iteration_index;
+
+        // rank(i, c) and select(k, c) of symbols c drawn from the BWT,
+        // select(k, c) = j for the k-th occurrence c = bwt[j].
+        std::vector<uint64_t> positions(max_iteration_index), symbols(max_iteration_index);
+        std::vector<uint64_t> occurrences(max_iteration_index), occurrence_symbols(max_iteration_index);
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            positions[i] = dice();
+            symbols[i] = wt[dice()];
+            occurrence_symbols[i] = wt[positions[i]];
+            occurrences[i] = wt.rank(positions[i] + 1, occurrence_symbols[i]);
+        }
+
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            volatile uint64_t r = wt.rank(positions[i], symbols[i]);
+        }
+        e = time();
+        perf_sample rank_counters = counters.stop();
+        double rank_time_per_element = microseconds() / max_iteration_index;
+
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            volatile uint64_t j = wt.select(occurrences[i], occurrence_symbols[i]);
+        }
+        e = time();
+        perf_sample select_counters = counters.stop();
+        double select_time_per_element = microseconds() / max_iteration_index;
+
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            volatile uint64_t r = wt.inverse_select(positions[i]).first;
+        }
+        e = time();
+        perf_sample inverse_select_counters = counters.stop();
+        double inverse_select_time_per_element = microseconds() / max_iteration_index;
+
+        int_vector<64> C(257, 0);
+        add_symbol_counts(C, text);
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            volatile uint64_t j = lfStep(wt, C, positions[i]);
+        }
+        e = time();
+        perf_sample lf_counters = counters.stop();
+        double lf_time_per_element = microseconds() / max_iteration_index;
+
+        if (test)
+        {
+            for (size_t i = 0; i < max_iteration_index; ++i)
+            {
+                uint64_t j = positions[i];
+                uint64_t selected = wt.select(occurrences[i], occurrence_symbols[i]);
+                uint64_t lf = lfStep(wt, C, j);
+                if (selected != j || psi[lf] != j)
+                {
+                    cout << "Failed to select or LF-map!" << endl;
+                    cout << "Idx=" << j << " - Select=" << selected << " - Psi of LF=" << psi[lf] << endl;
+                    abort();
+                }
+            }
+        }
+
+        cout << "RESULT"
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " ConstructionTime=" << construction_time
+             << " ConstructionPeakRSS=" << construction_peak_rss
+             << " SpaceBitsPerElement=" << space_bits_per_element
+             << " RandomAccessTimePerElement=" << random_access_time_per_element;
+        printLatency("RandomAccessLatency", random_access_latency);
+        cout << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element
+             << " RankTimePerElement=" << rank_time_per_element
+             << " SelectTimePerElement=" << select_time_per_element
+             << " InverseSelectTimePerElement=" << inverse_select_time_per_element
+             << " LFTimePerElement=" << lf_time_per_element;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", n);
+        random_access_counters.print(cout, "RandomAccess", max_iteration_index);
+        sequential_access_counters.print(cout, "SequentialAccess", max_iteration_index);
+        rank_counters.print(cout, "Rank", max_iteration_index);
+        select_counters.print(cout, "Select", max_iteration_index);
+        inverse_select_counters.print(cout, "InverseSelect", max_iteration_index);
+        lf_counters.print(cout, "LF", max_iteration_index);
+        cout << endl;
+
+        throughputExperiment(vector_type, wt);
+
+        int_vector<> lf;
+        if (test)
+        {
+            lf = int_vector<>(n, 0, bits::hi(n) + 1);
+            for (size_t i = 0; i < n; ++i)
+            {
+                lf[psi[i]] = i;
+            }
+        }
+        walkExperiment("LFWalk", vector_type, n, [&wt, &C](uint64_t i) { return lfStep(wt, C, i); }, lf);
+
+        std::vector<string> patterns = samplePatterns(text);
+        counters.start();
+        s = time();
+        for (auto &pattern : patterns)
+        {
+            size_t count = backwardSearchCount(wt, C, pattern);
+            testOccurrences(pattern, count, nullptr, text);
+        }
+        e = time();
+        perf_sample count_counters = counters.stop();
+        double count_patterns_per_second = patterns.size() / seconds();
+        latency_histogram<> count_latency;
+        size_t counted_occurrences = 0;
+        for (auto &pattern : patterns)
+        {
+            uint64_t start = cycle_timer::now();
+            counted_occurrences += backwardSearchCount(wt, C, pattern);
+            count_latency.add(cycle_timer::elapsed(start));
+        }
+
+        cout << "RESULT"
+             << " Experiment=Pattern"
+             << " Vector=" << vector_type
+             << " Benchmark=" << test_id
+             << " ConstructionTime=" << construction_time
+             << " ConstructionPeakRSS=" << construction_peak_rss
+             << " SpaceBitsPerSymbol=" << space_bits_per_element
+             << " PatternLength=" << pattern_length
+             << " CountPatternsPerSecond=" << count_patterns_per_second;
+        printLatency("CountLatency", count_latency);
+        cout << " CountedOccurrences=" << counted_occurrences;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", n);
+        count_counters.print(cout, "Count", patterns.size());
+        cout << endl;
+    }
+};
+
+template<class t_bit_vector>
+class BitVectorExperiment {
+
+  typedef typename t_bit_vector::rank_0_type rank_0;
+  typedef typename t_bit_vector::rank_1_type rank_1;
+  typedef typename t_bit_vector::select_0_type select_0;
+  typedef typename t_bit_vector::select_1_type select_1;
+
+  public:
+    BitVectorExperiment(string &vector_type, const string &benchmark, bit_vector &vec)
+    {
+        uint64_t ones = util::cnt_one_bits(vec);
+        reset_peak_rss();
+        heap_monitor::start();
+        counters.start();
+        s = time();
+        t_bit_vector bit_vec(vec);
+        e = time();
+        perf_sample construction_counters = counters.stop();
+        heap_sample construction_heap = heap_monitor::stop();
+        double construction_time = seconds();
+        double space_bits_per_element = 8.0 * (static_cast<double>(size_in_bytes(bit_vec)) / static_cast<double>(vec.size()));
+
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<uint64_t> distribution(0, vec.size() - 1);
+        auto dice = bind(distribution, rng);
+
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t val = bit_vec[j];
+        }
+        e = time();
+        perf_sample random_access_counters = counters.stop();
+        double random_access_time_per_element = microseconds() / max_iteration_index;
+
+        size_t sequential_accesses = std::min(max_iteration_index, vec.size());
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < sequential_accesses; ++i)
+        {
+            volatile uint64_t val = bit_vec[i];
+        }
+        e = time();
+        perf_sample sequential_access_counters = counters.stop();
+        double sequential_acces_time_per_element = microseconds() / sequential_accesses;
+
+        rank_0 rank0(&bit_vec);
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t val = rank0(j);
+        }
+        e = time();
+        perf_sample rank0_counters = counters.stop();
+        double rank0_time_per_element = microseconds() / max_iteration_index;
+
+        rank_1 rank1(&bit_vec);
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index; ++i)
+        {
+            size_t j = dice();
+            volatile uint64_t val = rank1(j);
+        }
+        e = time();
+        perf_sample rank1_counters = counters.stop();
+        double rank1_time_per_element = microseconds() / max_iteration_index;
+
+        std::uniform_int_distribution<uint64_t> distribution_select_0(1, std::max<uint64_t>(1, vec.size() - ones));
+        auto dice0 = bind(distribution_select_0, rng);
+        select_0 select0(&bit_vec);
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index && ones < vec.size(); ++i)
+        {
+            size_t j = dice0();
+            volatile uint64_t val = select0(j);
+        }
+        e = time();
+        perf_sample select0_counters = counters.stop();
+        double select0_time_per_element = microseconds() / max_iteration_index;
+
+        std::uniform_int_distribution<uint64_t> distribution_select_1(1, std::max<uint64_t>(1, ones));
+        auto dice1 = bind(distribution_select_1, rng);
+        select_1 select1(&bit_vec);
+        counters.start();
+        s = time();
+        for (size_t i = 0; i < max_iteration_index && ones > 0; ++i)
+        {
+            size_t j = dice1();
+            volatile uint64_t val = select1(j);
+        }
+        e = time();
+        perf_sample select1_counters = counters.stop();
+        double select1_time_per_element = microseconds() / max_iteration_index;
+
+        cout << "RESULT"
+             << " Experiment=BitVector"
+             << " Vector=" << vector_type
+             << " Benchmark=" << benchmark
+             << " Length=" << vec.size()
+             << " Ones=" << ones
+             << " ConstructionTime=" << construction_time
+             << " SpaceBitsPerElement=" << space_bits_per_element
+             << " RandomAccessTimePerElement=" << random_access_time_per_element
+             << " SequentialAccessTimePerElement=" << sequential_acces_time_per_element
+             << " Rank0TimePerElement=" << rank0_time_per_element
+             << " Rank1TimePerElement=" << rank1_time_per_element
+             << " Select0TimePerElement=" << select0_time_per_element
+             << " Select1TimePerElement=" << select1_time_per_element;
+        construction_heap.print(cout, "Construction");
+        construction_counters.print(cout, "Construction", vec.size());
+        random_access_counters.print(cout, "RandomAccess", max_iteration_index);
+        sequential_access_counters.print(cout, "SequentialAccess", sequential_accesses);
+        rank0_counters.print(cout, "Rank0", max_iteration_index);
+        rank1_counters.print(cout, "Rank1", max_iteration_index);
+        select0_counters.print(cout, "Select0", max_iteration_index);
+        select1_counters.print(cout, "Select1", max_iteration_index);
+        cout << endl;
+    }
+};
+
+//! Bit vector of length n with about runs runs of ones.
+/*! Runs of ones and the gaps between them have a length between n/(4*runs)
+ *  and n/(2*runs).
+ */
+bit_vector syntheticBitmap(size_t n, size_t runs)
+{
+    bit_vector b(n, 0);
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> distribution(n / (4 * runs), n / (2 * runs));
+    auto dice = bind(distribution, rng);
+    size_t idx = 0;
+    for (size_t i = 0; i < runs && idx < n; ++i)
+    {
+        uint64_t run_length = dice();
+        for (size_t j = idx; j < std::min(idx + run_length, n); ++j)
+        {
+            b[j] = 1;
+        }
+        idx += run_length + dice();
+    }
+    return b;
+}
+
+//! Bit vectors derived from the cached BWT and psi, named for the Benchmark field.
+/*! bwt_run_heads marks the first position of every BWT run, as in wt_rlmn.
+ *  bwt_occurrences_<c> marks the occurrences of c in the BWT, the bit
+ *  vectors wt_huff<rl_bit_vector<>> splits the BWT into, for the most
+ *  frequent symbol and the symbol of median frequency. psi_run_starts marks
+ *  every i with psi[i] != psi[i-1] + 1, the runs the psi vectors encode.
+ */
+std::vector<std::pair<string, bit_vector>> indexBitmaps(cache_config &config, const int_vector<> &psi)
+{
+    std::vector<std::pair<string, bit_vector>> bitmaps;
+    int_vector_buffer<8> bwt(cache_file_name(conf::KEY_BWT, config));
+    size_t n = bwt.size();
+
+    bit_vector heads(n, 0);
+    std::vector<uint64_t> counts(256, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        heads[i] = (i == 0 || bwt[i] != bwt[i - 1]);
+        ++counts[bwt[i]];
+    }
+    bitmaps.emplace_back("bwt_run_heads", std::move(heads));
+
+    // Symbols by decreasing frequency, without the terminator.
+    std::vector<uint64_t> symbols;
+    for (uint64_t c = 1; c < counts.size(); ++c)
+    {
+        if (counts[c] > 0)
+        {
+            symbols.push_back(c);
+        }
+    }
+    std::stable_sort(symbols.begin(), symbols.end(), [&counts](uint64_t a, uint64_t b) { return counts[a] > counts[b]; });
+    if (symbols.size() > 2)
+    {
+        symbols = {symbols.front(), symbols[symbols.size() / 2]};
+    }
+    for (uint64_t c : symbols)
+    {
+        bit_vector occurrences(n, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            occurrences[i] = (bwt[i] == c);
+        }
+        bitmaps.emplace_back("bwt_occurrences_" + to_string(c), std::move(occurrences));
+    }
+
+    bit_vector starts(psi.size(), 0);
+    for (size_t i = 0; i < psi.size(); ++i)
+    {
+        starts[i] = (i == 0 || psi[i] != psi[i - 1] + 1);
+    }
+    bitmaps.emplace_back("psi_run_starts", std::move(starts));
+    return bitmaps;
+}
+
+//! Build the cached BWT and psi of test_file and load psi.
+/*! On the massive path, i.e. under a RAM budget smaller than the psi file,
+ *  psi is not loaded and psi_streamed is set: the psi experiments build
+ *  their vectors from the cached psi and check them against it front to
+ *  back, the experiments needing the psi array are skipped.
+ */
+void prepareIndex(cache_config &test_config, int_vector<> &psi)
+{
+    // Without a RAM budget psi is read off the BWT in memory. Under a budget
+    // the BWT and psi are built semi-externally from the suffix array.
+    if (construction_ram_budget == 0 && !cache_file_exists(conf::KEY_BWT, test_config))
+    {
+        reset_peak_rss();
+        heap_monitor::start();
+        construction_stages stages;
+        s = time();
+        construct_bwt_in_memory(test_config, test_file, construction_threads, stages);
+        e = time();
+        constructionResult("bwt", heap_monitor::stop(), stages);
+    }
+
+    string psi_file = cache_file_name(conf::KEY_PSI, test_config);
+    if (!cache_file_exists(conf::KEY_PSI, test_config))
+    {
+        reset_peak_rss();
+        heap_monitor::start();
+        construction_stages stages;
+        external_scans scans;
+        s = time();
+        if (construction_ram_budget == 0)
+        {
+            construct_psi_from_bwt(test_config, construction_threads, stages);
+        }
+        else
+        {
+            construct_psi_semi_external(test_config, test_file, construction_ram_budget, stages, scans);
+        }
+        e = time();
+        constructionResult("psi", heap_monitor::stop(), stages, scans);
+    }
+    psi_streamed = construction_ram_budget > 0 && util::file_size(psi_file) > construction_ram_budget;
+    if (!psi_streamed)
+    {
+        load_from_file(psi, psi_file);
+    }
+
+    if (!cache_file_exists(conf::KEY_BWT, test_config))
+    {
+        reset_peak_rss();
+        heap_monitor::start();
+        construction_stages stages;
+        s = time();
+        if (cache_file_exists(conf::KEY_SA, test_config))
+        {
+            timed_stage(stages, "Bwt", [&]() {
+                cout << "Construct BWT..." << endl;
+                construct_bwt<8>(test_config);
+            });
+        }
+        else
+        {
+            construct_bwt_in_memory(test_config, test_file, construction_threads, stages);
+        }
+        e = time();
+        constructionResult("bwt", heap_monitor::stop(), stages);
+    }
+}
+
+//! Inputs of the experiments, built on first use.
+/*! An experiment only builds what it needs, so selecting e.g. the bit vector
+ *  experiments does not construct the index of the benchmark.
+ */
+struct experiment_inputs
+{
+    cache_config config;
+    int_vector<> psi;
+    int_vector<8> text;
+    bit_vector bitmap;
+    std::vector<std::pair<string, bit_vector>> bitmaps;
+    bool has_index = false;
+    bool has_text = false;
+    bool has_bitmap = false;
+    bool has_bitmaps = false;
+
+    void requireBenchmark()
+    {
+        if (test_file.empty() || temp_dir.empty())
+        {
+            throw std::invalid_argument("this experiment needs a benchmark file and a temp directory");
+        }
+    }
+
+    int_vector<> &index()
+    {
+        if (!has_index)
+        {
+            requireBenchmark();
+            prepareIndex(config, psi);
+            has_index = true;
+        }
+        return psi;
+    }
+
+    cache_config &bwt()
+    {
+        index();
+        return config;
+    }
+
+    //! psi in memory, std::length_error skips the experiment if psi is streamed.
+    int_vector<> &psi_array()
+    {
+        index();
+        if (psi_streamed)
+        {
+            throw std::length_error("psi exceeds the RAM budget of " + to_string(construction_ram_budget / (1024 * 1024)) +
+                                    " MiB and is not loaded");
+        }
+        return psi;
+    }
+
+    int_vector<8> &input_text()
+    {
+        if (!has_text)
+        {
+            requireBenchmark();
+            load_vector_from_file(text, test_file, 1);
+            append_zero_symbol(text);
+            has_text = true;
+        }
+        return text;
+    }
+
+    bit_vector &synthetic_bitmap()
+    {
+        if (!has_bitmap)
+        {
+            bitmap = syntheticBitmap(bit_vector_length, bit_vector_runs);
+            has_bitmap = true;
+        }
+        return bitmap;
+    }
+
+    std::vector<std::pair<string, bit_vector>> &index_bitmaps()
+    {
+        if (!has_bitmaps)
+        {
+            cache_config &config = bwt();
+            bitmaps = indexBitmaps(config, psi_array());
+            has_bitmaps = true;
+        }
+        return bitmaps;
+    }
+};
+
+template<class t_vector>
+void registerPsiExperiment(experiment_registry &registry, const string &group, string algo, experiment_inputs &inputs, psi_source source = psi_source::array)
+{
+    registry.add(group, algo, [algo, &inputs, source]() mutable {
+        PsiVectorExperiment<t_vector> experiment(algo, inputs.index(), source, &inputs.config);
+    }, [&inputs]() { inputs.index(); });
+}
+
+//! Registers PsiVectorExperiment for every configuration of a parameter_grid.
+struct psi_grid_registrar
+{
+    experiment_registry &registry;
+    string group;
+    string algo;
+    experiment_inputs &inputs;
+
+    template<class t_vector>
+    void operator()(type_tag<t_vector>, const string &parameters)
+    {
+        registerPsiExperiment<t_vector>(registry, group, algo + "_" + parameters, inputs);
+    }
+};
+
+//! Register group/algo_<parameters> for every combination of the parameter lists t_lists.
+template<template<class...> class t_config, class... t_lists>
+void registerPsiGrid(experiment_registry &registry, const string &group, const string &algo, experiment_inputs &inputs)
+{
+    psi_grid_registrar registrar{registry, group, algo, inputs};
+    parameter_grid<t_config, t_lists...>::for_each(registrar);
+}
+
+template<class t_mapper_vector, class t_mapper>
+void registerMappedExperiment(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("psi", algo, [algo, &inputs]() mutable {
+        MappedPsiVectorExperiment<t_mapper_vector, t_mapper> experiment(algo, inputs.index(), inputs.config);
+    }, [&inputs]() { inputs.index(); });
+}
+
+template<class t_wt>
+void registerBWTExperiment(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("bwt", algo, [algo, &inputs]() mutable {
+        cache_config &config = inputs.bwt();
+        BWTExperiment<t_wt> experiment(algo, config, inputs.input_text(), inputs.psi_array());
+    }, [&inputs]() { inputs.bwt(); inputs.input_text(); });
+}
+
+template<class t_psi_vector>
+void registerPatternExperiment(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("pattern", algo, [algo, &inputs]() mutable {
+        cache_config &config = inputs.bwt();
+        PatternExperiment<t_psi_vector> experiment(algo, inputs.input_text(), config);
+    }, [&inputs]() { inputs.bwt(); inputs.input_text(); });
+}
+
+template<class t_psi_vector>
+void registerSampleRateSweep(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("samplerate", algo, [algo, &inputs]() mutable {
+        cache_config &config = inputs.bwt();
+        sampleRateSweep<t_psi_vector, 4, 8, 16, 32, 64, 128, 256>(algo, inputs.input_text(), config);
+    }, [&inputs]() { inputs.bwt(); inputs.input_text(); });
+}
+
+template<class t_psi_vector>
+void registerMergeExperiment(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("merge", algo, [algo, &inputs]() mutable {
+        MergeExperiment<t_psi_vector> experiment(algo, inputs.input_text());
+    }, [&inputs]() { inputs.input_text(); });
+}
+
+template<class t_bit_vector>
+void registerBitVectorExperiment(experiment_registry &registry, string algo, experiment_inputs &inputs)
+{
+    registry.add("bitvector", algo, [algo, &inputs]() mutable {
+        string benchmark = "synthetic_" + to_string(bit_vector_length) + "_" + to_string(bit_vector_runs);
+        BitVectorExperiment<t_bit_vector> experiment(algo, benchmark, inputs.synthetic_bitmap());
+    }, [&inputs]() { inputs.synthetic_bitmap(); });
+    registry.add("indexbitvector", algo, [algo, &inputs]() mutable {
+        for (auto &bitmap : inputs.index_bitmaps())
+        {
+            BitVectorExperiment<t_bit_vector> experiment(algo, test_id + "_" + bitmap.first, bitmap.second);
+        }
+    }, [&inputs]() { inputs.index_bitmaps(); });
+}
+
+void usage(const char *program)
+{
+    cout << "Usage: " << program << " [benchmark temp_dir [threads [ram_budget_mib]]] [options]\n"
+         << "  --select a,b,...    experiments to run: a group, a group/name or all, * is a wildcard\n"
+         << "  --list              list the experiments and exit\n"
+         << "  --test              check the results of the queries against psi and the text\n"
+         << "  --repetitions n     measured runs of every experiment (default 1)\n"
+         << "  --warmup n          unreported runs before the measured ones (default 0)\n"
+         << "  --queries n         queries per timed loop (default " << max_iteration_index << ")\n"
+         << "  --patterns n        patterns of the pattern experiments (default " << pattern_count << ")\n"
+         << "  --pattern-length n  length of the patterns (default " << pattern_length << ")\n"
+         << "  --walk-steps n      steps of every psi walk (default " << walk_steps << ")\n"
+         << "  --seed n            seed of the random queries (default " << seed << ")\n"
+         << "  --format f          result, csv or json (default result)\n"
+         << "  --threads n         construction threads (default 1)\n"
+         << "  --ram-budget n      RAM budget of the psi construction in MiB (default 0, in memory),\n"
+         << "                      a larger psi is streamed from disk and not checked query by query\n"
+         << "  --merge-batch n     percent of the text merged into the index (default " << merge_batch_percent << ")\n"
+         << "  --bv-length n       length of the synthetic bit vector (default " << bit_vector_length << ")\n"
+         << "  --bv-runs n         runs of ones in the synthetic bit vector (default " << bit_vector_runs << ")\n";
+}
+
+int runExperiments(int argc, char *argv[])
+{
+    benchmark_options options(argc, argv, {"list", "help", "test"});
+    const vector<string> &args = options.positional();
+    if (options.has("help"))
+    {
+        usage(argv[0]);
+        return 0;
+    }
+
+    if (args.size() > 1)
+    {
+        test_file = args[0];
+        temp_dir = args[1];
+        test_id = test_file.substr(test_file.find_last_of("/\\") + 1);
+    }
+    if (args.size() > 2)
+    {
+        construction_threads = std::max(1, atoi(args[2].c_str()));
+    }
+    if (args.size() > 3)
+    {
+        construction_ram_budget = strtoull(args[3].c_str(), nullptr, 10) * 1024 * 1024;
+    }
+    construction_threads = std::max((size_t)1, options.get("threads", construction_threads));
+    construction_ram_budget = options.get("ram-budget", construction_ram_budget / (1024 * 1024)) * 1024 * 1024;
+    test = options.has("test");
+    max_iteration_index = options.get("queries", max_iteration_index);
+    pattern_count = options.get("patterns", pattern_count);
+    pattern_length = options.get("pattern-length", pattern_length);
+    walk_steps = std::max((size_t)1, options.get("walk-steps", walk_steps));
+    seed = options.get("seed", seed);
+    merge_batch_percent = options.get("merge-batch", merge_batch_percent);
+    bit_vector_length = options.get("bv-length", bit_vector_length);
+    bit_vector_runs = std::max((size_t)1, options.get("bv-runs", bit_vector_runs));
+    size_t repetitions = options.get("repetitions", (size_t)1);
+    size_t warmup = options.get("warmup", (size_t)0);
+
+    for (size_t threads = 1; threads < std::thread::hardware_concurrency(); threads *= 2)
+    {
+        throughput_threads.push_back(threads);
+    }
+    throughput_threads.push_back(std::max(1u, std::thread::hardware_concurrency()));
+
+    experiment_inputs inputs;
+    inputs.config = cache_config(false, temp_dir, test_id);
+
+    experiment_registry registry;
+    registry.set_default_group("psi");
+    registry.set_default_group("bwt");
+    registry.set_default_group("pattern");
+    registry.set_default_group("samplerate");
+
+    registerPsiExperiment<rlcsa_psi_vector<>>(registry, "psi", "rlcsa_vector", inputs);
+    registerPsiExperiment<rlcsa_psi_vector<>>(registry, "psi", "rlcsa_vector_bwt_runs", inputs, psi_source::bwt_runs);
+    registerPsiExperiment<rlcsa_psi_vector<>>(registry, "psi", "rlcsa_vector_streamed", inputs, psi_source::file);
+    registerPsiExperiment<rlcsa_psi_vector<sd_alphabet_boundaries<sd_vector<>>>>(registry, "psi", "rlcsa_vector_sd_boundaries", inputs);
+    // hyb_sd_vector has no constructor for sorted positions, the runs of the BWT exercise the bit_vector fallback.
+    registerPsiExperiment<rlcsa_psi_vector<sd_alphabet_boundaries<hyb_sd_vector<>>>>(registry, "psi", "rlcsa_vector_hyb_sd_boundaries", inputs, psi_source::bwt_runs);
+    registerMappedExperiment<rlcsa_psi_vector<>, rlcsa_run_table>(registry, "rlcsa_run_table", inputs);
+    registerPsiExperiment<sdsl_psi_vector<rl_bitenc_vector>>(registry, "psi", "rl_bitenc_vector", inputs);
+    registerPsiExperiment<sdsl_psi_vector<rl_vec<16>>>(registry, "psi", "rl_vector_16", inputs);
+    registerPsiExperiment<sdsl_psi_vector<rl_inc_vector<dac_vector_dp<>, sd_vector<>, 8>>>(registry, "psi", "rl_inc_vector", inputs);
+    registerBWTExperiment<wt_rlmn<>>(registry, "wt_rlmn_bwt_vector", inputs);
+    registerBWTExperiment<wt_huff<rl_bit_vector<>>>(registry, "wt_rl_huff_bwt_vector", inputs);
+    registerPsiExperiment<sdsl_psi_vector<enc_vector<>>>(registry, "psi", "enc_vector", inputs);
+    registerPsiExperiment<sdsl_psi_vector<enc_vector<>>>(registry, "psi", "enc_vector_bwt_runs", inputs, psi_source::bwt_runs);
+    registerPsiExperiment<sdsl_psi_vector<hybrid_bucket_vector<>>>(registry, "psi", "hybrid_vector", inputs);
+
+    registerPatternExperiment<rlcsa_psi_vector<>>(registry, "rlcsa_vector", inputs);
+    registerPatternExperiment<sdsl_psi_vector<rl_inc_vector<dac_vector_dp<>, sd_vector<>, 8>>>(registry, "rl_inc_vector", inputs);
+    registerPatternExperiment<sdsl_psi_vector<enc_vector<>>>(registry, "enc_vector", inputs);
+    registerPatternExperiment<sdsl_psi_vector<hybrid_bucket_vector<>>>(registry, "hybrid_vector", inputs);
+
+    registerSampleRateSweep<rlcsa_psi_vector<>>(registry, "rlcsa_vector", inputs);
+    registerSampleRateSweep<sdsl_psi_vector<enc_vector<>>>(registry, "enc_vector", inputs);
+
+    // Sample densities of rl_inc_vector, formerly rlvector_sampling_experiment,
+    // next to the RLEVector block sizes of rlcsa_psi_vector in bytes.
+    registerPsiGrid<rl_inc_config, uint_list<1, 2, 4, 8, 16, 32, 64, 128, 256>>(registry, "sampling", "rl_inc_vector", inputs);
+    registerPsiGrid<rlcsa_config, uint_list<16, 32, 64, 128, 256, 512>>(registry, "sampling", "rlcsa_vector", inputs);
+
+#ifdef PARAMETER_GRID
+    // Full parameter grids, e.g. rl_vector_fibonacci_32. Each point is a
+    // separate instantiation, which is why they are only compiled on request.
+    registerPsiGrid<rl_vector_config, grid_coders, uint_list<8, 16, 32, 64>>(registry, "grid", "rl_vector", inputs);
+    registerPsiGrid<enc_vector_config, grid_coders, uint_list<16, 32, 64, 128>>(registry, "grid", "enc_vector", inputs);
+    registerPsiGrid<rl_inc_levels_config, uint_list<2, 4, 8>, uint_list<4, 8, 16, 32>>(registry, "grid", "rl_inc_vector_levels", inputs);
+#endif
+
+    // Merge of a new batch into an index against the full rebuild.
+    registerMergeExperiment<rlcsa_psi_vector<>>(registry, "rlcsa_vector", inputs);
+    registerMergeExperiment<sdsl_psi_vector<enc_vector<>>>(registry, "enc_vector", inputs);
+
+    // Bit vectors, formerly bit_vector_test: synthetic ones in bitvector, the
+    // ones derived from the index of the benchmark in indexbitvector.
+    registerBitVectorExperiment<rl_bit_vector<>>(registry, "rl_bit_vector", inputs);
+    registerBitVectorExperiment<bit_vector>(registry, "bit_vector", inputs);
+    registerBitVectorExperiment<sd_vector<>>(registry, "sd_vector", inputs);
+    registerBitVectorExperiment<rrr_vector<>>(registry, "rrr_vector", inputs);
+    registerBitVectorExperiment<hyb_sd_vector<>>(registry, "hyb_sd_vector", inputs);
+
+    if (options.has("list"))
+    {
+        registry.list(cout);
+        return 0;
+    }
+
+    auto selected = registry.select(options.list("select"));
+    result_format_buf result_buf(cout, cerr.rdbuf(), options.get("format", string("result")));
+    for (auto experiment : selected)
+    {
+        // A structure too small for the benchmark, e.g. rlcsa_psi_vector
+        // without MASSIVE_DATA_RLCSA beyond 4 Gi symbols, or an input not
+        // loaded on the massive path skips only its experiment.
+        try
+        {
+            if (experiment->prepare)
+            {
+                experiment->prepare();
+            }
+            result_buf.set_discard(true);
+            for (size_t i = 0; i < warmup; ++i)
+            {
+                experiment->run();
+            }
+            result_buf.set_discard(false);
+            for (size_t i = 0; i < repetitions; ++i)
+            {
+                result_buf.set_fields(repetitions > 1 ? " Repetition=" + to_string(i) : "");
+                experiment->run();
+            }
+        }
+        catch (std::length_error &ex)
+        {
+            cout << "Skip " << experiment->id() << ": " << ex.what() << endl;
+        }
+        result_buf.set_discard(false);
+        result_buf.set_fields("");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        return runExperiments(argc, argv);
+    }
+    catch (std::invalid_argument &ex)
+    {
+        cerr << "Error: " << ex.what() << endl;
+        usage(argv[0]);
+        return 1;
+    }
+}
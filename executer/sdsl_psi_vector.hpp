@@ -22,6 +22,10 @@
 #define SDSL_PSI_VECTOR
 
 #include <vector>
+#include <iterator>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 #include <sdsl/int_vector.hpp>
 #include <sdsl/enc_vector.hpp>
@@ -31,10 +35,119 @@
 #include <sdsl/coder.hpp>
 #include <sdsl/iterators.hpp>
 
+#include "alphabet_boundaries.hpp"
+#include "parallel_construction.hpp"
+#include "psi_runs.hpp"
+
 //! Namespace for the succinct data structure library.
 namespace sdsl
 {
 
+//! Number of consecutive bucket elements decoded at once by the sequential iterator.
+template <class t_vector>
+inline uint64_t psi_block_size(const t_vector &)
+{
+    return 64;
+}
+
+template <class t_coder, uint32_t t_dens, uint8_t t_width>
+inline uint64_t psi_block_size(const enc_vector<t_coder, t_dens, t_width> &)
+{
+    return t_dens;
+}
+
+//! Whether psi_decode_block decodes a block of v in one pass.
+/*! Otherwise it falls back to operator[] per element, and a batch of
+ *  accesses is answered element by element instead.
+ */
+template <class t_vector>
+inline bool psi_decodes_blocks(const t_vector &)
+{
+    return false;
+}
+
+template <class t_coder, uint32_t t_dens, uint8_t t_width>
+inline bool psi_decodes_blocks(const enc_vector<t_coder, t_dens, t_width> &)
+{
+    return true;
+}
+
+//! Decode v[i..i+n-1] into buf, i is a multiple of psi_block_size(v).
+template <class t_vector>
+inline void psi_decode_block(const t_vector &v, uint64_t i, uint64_t n, uint64_t *buf)
+{
+    for (uint64_t k = 0; k < n; ++k)
+    {
+        buf[k] = v[i + k];
+    }
+}
+
+//! enc_vector decodes a whole sample block in one pass over the codes.
+template <class t_coder, uint32_t t_dens, uint8_t t_width>
+inline void psi_decode_block(const enc_vector<t_coder, t_dens, t_width> &v, uint64_t i, uint64_t n, uint64_t *buf)
+{
+    uint64_t sample = v.sample(i / t_dens);
+    v.get_inter_sampled_values(i / t_dens, buf);
+    for (uint64_t k = 0; k < n; ++k)
+    {
+        buf[k] += sample;
+    }
+}
+
+//! First index j of the increasing vector v with v[j] >= x, v.size() if there is none.
+template <class t_vector>
+inline uint64_t psi_lower_bound(const t_vector &v, uint64_t x)
+{
+    uint64_t lo = 0, hi = v.size();
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (v[mid] < x)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//! enc_vector binary searches its samples and decodes a single block.
+template <class t_coder, uint32_t t_dens, uint8_t t_width>
+inline uint64_t psi_lower_bound(const enc_vector<t_coder, t_dens, t_width> &v, uint64_t x)
+{
+    uint64_t lo = 0, hi = (v.size() + t_dens - 1) / t_dens;
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (v.sample(mid) < x)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo == 0)
+    {
+        return 0;
+    }
+    // v.sample(lo-1) < x <= v.sample(lo), the answer is in block lo-1 or at its end.
+    uint64_t start = (lo - 1) * t_dens;
+    uint64_t n = std::min((uint64_t)t_dens, v.size() - start);
+    uint64_t buf[t_dens];
+    psi_decode_block(v, start, n, buf);
+    uint64_t k = 1;
+    while (k < n && buf[k] < x)
+    {
+        ++k;
+    }
+    return start + k;
+}
+
 //! A generic immutable space-saving vector class for unsigned integers.
 /*! A vector v is stored more space-efficiently by self-delimiting coding
  *  the deltas v[i+1]-v[i] (v[-1]:=0). Space of the structure and random
@@ -46,20 +159,18 @@ namespace sdsl
  *  This class is a parameter of csa_sada.
  * @ingroup int_vector
  */
-template <class t_vector=enc_vector<>>
+template <class t_vector=enc_vector<>, class t_boundaries=small_alphabet_boundaries<>>
 class sdsl_psi_vector
 {
   private:
     //static_assert(t_dens > 1 , "sdsl_psi_vector: sample density must be larger than `1`");
   public:
     typedef uint64_t value_type;
-    typedef random_access_const_iterator<sdsl_psi_vector> iterator;
-    typedef iterator const_iterator;
+    class const_iterator;
+    typedef const_iterator iterator;
     typedef ptrdiff_t difference_type;
     typedef int_vector<>::size_type size_type;
     typedef iv_tag index_category;
-    typedef typename sd_vector<>::rank_1_type rank_support;
-    typedef typename sd_vector<>::select_1_type select_support;
 
   private:
     size_type m_size = 0; // number of vector elements
@@ -67,9 +178,7 @@ class sdsl_psi_vector
 
 
     std::vector<t_vector> m_c;
-    sd_vector<> m_alphabet_marker;
-    rank_support m_alphabet_rank;
-    select_support m_alphabet_select;
+    t_boundaries m_boundaries;
 
     void
     clear()
@@ -88,9 +197,18 @@ class sdsl_psi_vector
 
     //! Constructor for a Container of unsigned integers.
     /*! \param c A container of unsigned integers.
+     *  \param threads Number of threads encoding the buckets.
           */
     template <class Container>
-    sdsl_psi_vector(const Container &c);
+    sdsl_psi_vector(const Container &c, size_type threads = 1);
+
+    //! Constructor for the runs of psi read off the BWT.
+    /*! Each bucket is expanded from its runs and encoded on its own, so only
+     *  one bucket of psi is in memory per thread.
+     *  \param runs    The runs of psi.
+     *  \param threads Number of threads encoding the buckets.
+     */
+    sdsl_psi_vector(const psi_runs &runs, size_type threads = 1);
 
     //! Constructor for an int_vector_buffer of unsigned integers.
     /*
@@ -140,6 +258,43 @@ class sdsl_psi_vector
          */
     value_type operator[](size_type i) const;
 
+    //! Access a batch of positions.
+    /*! The queries are sorted, so the bucket boundaries are resolved once
+     *  per bucket and, where psi_decodes_blocks, every block holding two or
+     *  more queries is decoded once for all of them.
+     *  \param idx   Positions to access.
+     *  \param n     Number of positions.
+     *  \param out   Receives psi[idx[k]] in out[k].
+     *  \param order Scratch space of n entries.
+         */
+    void access_batch(const uint64_t *idx, size_t n, uint64_t *out, uint64_t *order) const;
+
+    //! Number of buckets.
+    size_type buckets() const
+    {
+        return m_alphabet_size;
+    }
+
+    //! Bucket containing position i.
+    size_type bucket(size_type i) const
+    {
+        return m_boundaries.bucket(i);
+    }
+
+    //! First position of bucket c, bucket_start(buckets()) is size().
+    size_type bucket_start(size_type c) const
+    {
+        return m_boundaries.start(c);
+    }
+
+    //! Positions of bucket c whose psi values lie in [lo, hi].
+    /*! psi is increasing in a bucket, so the positions form an interval.
+     *  Both ends are found by psi_lower_bound, which uses the samples of
+     *  enc_vector and a binary search otherwise.
+     *  \return The interval [first, last) of positions, empty if first == last.
+     */
+    std::pair<size_type, size_type> range_search(size_type c, value_type lo, value_type hi) const;
+
     //! Serialize the sdsl_psi_vector to a stream.
     /*! \param out Out stream to write the data structure.
             \return The number of written bytes.
@@ -149,19 +304,172 @@ class sdsl_psi_vector
     //! Load the sdsl_psi_vector from a stream.
     void load(std::istream &in);
 
+    //! Forward iterator decoding the psi vector sequentially.
+    /*! The iterator stays inside the current bucket and decodes it block by
+     *  block with psi_decode_block, so the alphabet marker is only queried
+     *  when a bucket boundary is crossed. A full scan costs amortized O(1)
+     *  per element only for enc_vector buckets, which decode a block in one
+     *  pass, and plain int_vector buckets. The run-length buckets
+     *  (rl_inc_vector, rl_vector, rl_bitenc_vector, and hybrid_bucket_vector
+     *  buckets stored run-length) have no sequential decoder, so every
+     *  element costs an operator[] as in random access.
+     */
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename sdsl_psi_vector::value_type value_type;
+        typedef typename sdsl_psi_vector::difference_type difference_type;
+        typedef const value_type *pointer;
+        typedef value_type reference;
+
+      private:
+        const sdsl_psi_vector *m_v = nullptr;
+        size_type m_i = 0;
+        size_type m_alphabet = 0;
+        size_type m_bucket_start = 0;
+        size_type m_bucket_end = 0;
+        size_type m_block_start = 0;
+        size_type m_block_end = 0;
+        std::vector<uint64_t> m_block;
+
+        void decode()
+        {
+            if (m_i >= m_v->m_size)
+                return;
+            if (m_i >= m_bucket_end)
+            {
+                if (m_bucket_end > 0 && m_i == m_bucket_end)
+                {
+                    ++m_alphabet;
+                    m_bucket_start = m_bucket_end;
+                }
+                else
+                {
+                    m_alphabet = m_v->m_boundaries.bucket(m_i);
+                    m_bucket_start = m_v->m_boundaries.start(m_alphabet);
+                }
+                m_bucket_end = m_v->m_boundaries.start(m_alphabet + 1);
+            }
+            const t_vector &bucket = m_v->m_c[m_alphabet];
+            size_type block_size = psi_block_size(bucket);
+            size_type j = ((m_i - m_bucket_start) / block_size) * block_size;
+            size_type n = std::min(block_size, bucket.size() - j);
+            m_block.resize(block_size);
+            psi_decode_block(bucket, j, n, m_block.data());
+            m_block_start = m_bucket_start + j;
+            m_block_end = m_block_start + n;
+        }
+
+      public:
+        const_iterator() = default;
+
+        const_iterator(const sdsl_psi_vector *v, size_type i) : m_v(v), m_i(i)
+        {
+            decode();
+        }
+
+        reference operator*() const
+        {
+            return m_block[m_i - m_block_start];
+        }
+
+        const_iterator &operator++()
+        {
+            if (++m_i == m_block_end)
+                decode();
+            return *this;
+        }
 
+        const_iterator operator++(int)
+        {
+            const_iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const const_iterator &it) const
+        {
+            return m_v == it.m_v && m_i == it.m_i;
+        }
+
+        bool operator!=(const const_iterator &it) const
+        {
+            return !(*this == it);
+        }
+    };
 };
 
-template <class t_vector>
-inline typename sdsl_psi_vector<t_vector>::value_type
-    sdsl_psi_vector<t_vector>::operator[](const size_type i) const
+template <class t_vector, class t_boundaries>
+inline typename sdsl_psi_vector<t_vector, t_boundaries>::value_type
+    sdsl_psi_vector<t_vector, t_boundaries>::operator[](const size_type i) const
 {
-    size_type alphabet = m_alphabet_rank(i+1) - 1;
-    size_type alphabet_start_pos = m_alphabet_select(alphabet+1);
+    size_type alphabet = m_boundaries.bucket(i);
+    size_type alphabet_start_pos = m_boundaries.start(alphabet);
     value_type val = m_c[alphabet][i - alphabet_start_pos];
     return val;
 }
 
+template <class t_vector, class t_boundaries>
+void sdsl_psi_vector<t_vector, t_boundaries>::access_batch(const uint64_t *idx, size_t n, uint64_t *out, uint64_t *order) const
+{
+    const size_type max_block = 256;
+    uint64_t block[max_block];
+    std::iota(order, order + n, 0);
+    std::sort(order, order + n, [idx](uint64_t a, uint64_t b) { return idx[a] < idx[b]; });
+    size_type k = 0;
+    while (k < n)
+    {
+        size_type alphabet = m_boundaries.bucket(idx[order[k]]);
+        size_type alphabet_start_pos = m_boundaries.start(alphabet);
+        size_type alphabet_end_pos = m_boundaries.start(alphabet + 1);
+        const t_vector &bucket = m_c[alphabet];
+        size_type block_size = psi_block_size(bucket);
+        bool decode = psi_decodes_blocks(bucket) && block_size <= max_block;
+        while (k < n && idx[order[k]] < alphabet_end_pos)
+        {
+            size_type pos = idx[order[k]] - alphabet_start_pos;
+            size_type block_begin = pos - pos % block_size;
+            size_type block_end = std::min(block_begin + block_size, (size_type)bucket.size());
+            // The queries k..end-1 fall into the block of pos.
+            size_type end = k + 1;
+            while (end < n && idx[order[end]] < alphabet_start_pos + block_end)
+            {
+                ++end;
+            }
+            if (decode && end - k > 1)
+            {
+                psi_decode_block(bucket, block_begin, block_end - block_begin, block);
+                for (; k < end; ++k)
+                {
+                    out[order[k]] = block[idx[order[k]] - alphabet_start_pos - block_begin];
+                }
+            }
+            else
+            {
+                for (; k < end; ++k)
+                {
+                    out[order[k]] = bucket[idx[order[k]] - alphabet_start_pos];
+                }
+            }
+        }
+    }
+}
+
+template <class t_vector, class t_boundaries>
+inline std::pair<typename sdsl_psi_vector<t_vector, t_boundaries>::size_type, typename sdsl_psi_vector<t_vector, t_boundaries>::size_type>
+sdsl_psi_vector<t_vector, t_boundaries>::range_search(size_type c, value_type lo, value_type hi) const
+{
+    size_type start = m_boundaries.start(c);
+    if (lo > hi)
+    {
+        return std::make_pair(start, start);
+    }
+    size_type first = psi_lower_bound(m_c[c], lo);
+    size_type last = hi == std::numeric_limits<value_type>::max() ? m_c[c].size() : psi_lower_bound(m_c[c], hi + 1);
+    return std::make_pair(start + first, start + last);
+}
+
 /*template<class t_int_vector, class t_bit_vector, uint32_t t_dens, uint8_t t_width>
 inline typename sdsl_psi_vector<t_coder, t_dens,t_width>::value_type sdsl_psi_vector<t_coder, t_dens,t_width>::sample(const size_type i)const
 {
@@ -170,18 +478,21 @@ inline typename sdsl_psi_vector<t_coder, t_dens,t_width>::value_type sdsl_psi_ve
     return m_sample_vals_and_pointer[i<<1];
 }*/
 
-template <class t_vector>
-void sdsl_psi_vector<t_vector>::swap(sdsl_psi_vector<t_vector> &v)
+template <class t_vector, class t_boundaries>
+void sdsl_psi_vector<t_vector, t_boundaries>::swap(sdsl_psi_vector<t_vector, t_boundaries> &v)
 {
     if (this != &v)
     {
-        
+        std::swap(m_size, v.m_size);
+        std::swap(m_alphabet_size, v.m_alphabet_size);
+        m_c.swap(v.m_c);
+        std::swap(m_boundaries, v.m_boundaries);
     }
 }
 
-template <class t_vector>
+template <class t_vector, class t_boundaries>
 template <class Container>
-sdsl_psi_vector<t_vector>::sdsl_psi_vector(const Container &c)
+sdsl_psi_vector<t_vector, t_boundaries>::sdsl_psi_vector(const Container &c, size_type threads)
 {
 
     // clear bit_vectors
@@ -189,36 +500,50 @@ sdsl_psi_vector<t_vector>::sdsl_psi_vector(const Container &c)
     m_size = c.size();
 
     bit_vector alphabet_marker(m_size+1,0);
-    alphabet_marker[0] = 1;
-    alphabet_marker[m_size] = 1;
-    m_alphabet_size = 1;
-    for (size_type i = 1; i < m_size; ++i)
-    {
-        if(c[i] < c[i-1]) {
-            alphabet_marker[i] = 1;
-            m_alphabet_size++;
-        }
-    }
-    m_alphabet_marker = sd_vector<>(alphabet_marker);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    m_alphabet_size = mark_alphabet_boundaries(c, alphabet_marker, threads);
+    m_boundaries = t_boundaries(alphabet_marker);
 
     m_c.assign(m_alphabet_size,t_vector());
-    for (size_type i = 0; i < m_alphabet_size; ++i) {
-        size_type start = m_alphabet_select(i+1);
-        size_type end = m_alphabet_select(i+2);
+    parallel_for_buckets(m_boundaries, m_alphabet_size, threads, [&](size_type i) {
+        size_type start = m_boundaries.start(i);
+        size_type end = m_boundaries.start(i + 1);
         int_vector<> tmp(end-start,0);
         for (size_type j = start; j < end; ++j) {
             tmp[j - start] = c[j];
         }
         t_vector tmp_vec(tmp);
         m_c[i].swap(tmp_vec);
-    }
+    });
 }
 
-template <class t_vector>
+template <class t_vector, class t_boundaries>
+sdsl_psi_vector<t_vector, t_boundaries>::sdsl_psi_vector(const psi_runs &runs, size_type threads)
+{
+    clear();
+    m_size = runs.size();
+
+    bit_vector alphabet_marker(m_size+1,0);
+    runs.mark_buckets(alphabet_marker);
+    m_alphabet_size = runs.buckets();
+    m_boundaries = t_boundaries(alphabet_marker);
+
+    m_c.assign(m_alphabet_size,t_vector());
+    parallel_for_buckets(m_boundaries, m_alphabet_size, threads, [&](size_type i) {
+        size_type start = m_boundaries.start(i);
+        int_vector<> tmp(m_boundaries.start(i + 1) - start, 0);
+        for (size_type k = runs.bucket_begin(i); k < runs.bucket_begin(i + 1); ++k) {
+            for (size_type j = 0; j < runs.length(k); ++j) {
+                tmp[runs.head(k) - start + j] = runs.value(k) + j;
+            }
+        }
+        t_vector tmp_vec(tmp);
+        m_c[i].swap(tmp_vec);
+    });
+}
+
+template <class t_vector, class t_boundaries>
 template <uint8_t int_width>
-sdsl_psi_vector<t_vector>::sdsl_psi_vector(int_vector_buffer<int_width> &v_buf)
+sdsl_psi_vector<t_vector, t_boundaries>::sdsl_psi_vector(int_vector_buffer<int_width> &v_buf)
 {
     // clear bit_vectors
     clear();
@@ -236,15 +561,13 @@ sdsl_psi_vector<t_vector>::sdsl_psi_vector(int_vector_buffer<int_width> &v_buf)
             m_alphabet_size++;
         }
     }
-    m_alphabet_marker = sd_vector<>(alphabet_marker);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    m_boundaries = t_boundaries(alphabet_marker);
 
     m_c.resize(m_alphabet_size);
     for (size_type i = 0; i < m_alphabet_size; ++i)
     {
-        size_type start = m_alphabet_select(i + 1);
-        size_type end = m_alphabet_select(i + 2);
+        size_type start = m_boundaries.start(i);
+        size_type end = m_boundaries.start(i + 1);
         int_vector<> tmp(end - start, 0);
         for (size_type j = start; j < end; ++j)
         {
@@ -254,29 +577,27 @@ sdsl_psi_vector<t_vector>::sdsl_psi_vector(int_vector_buffer<int_width> &v_buf)
     }
 }
 
-template <class t_vector>
-sdsl_psi_vector<>::size_type sdsl_psi_vector<t_vector>::serialize(std::ostream &out, structure_tree_node *v, std::string name) const
+template <class t_vector, class t_boundaries>
+typename sdsl_psi_vector<t_vector, t_boundaries>::size_type sdsl_psi_vector<t_vector, t_boundaries>::serialize(std::ostream &out, structure_tree_node *v, std::string name) const
 {
     structure_tree_node *child = structure_tree::add_child(v, name, util::class_name(*this));
     size_type written_bytes = 0;
     written_bytes += write_member(m_size, out, child, "size");
     written_bytes += write_member(m_alphabet_size, out, child, "size");
     written_bytes += serialize_vector(m_c,out,child,"psi");
-    written_bytes += m_alphabet_marker.serialize(out, child, "alphabet marker");
+    written_bytes += m_boundaries.serialize(out, child, "alphabet marker");
     structure_tree::add_size(child, written_bytes);
     return written_bytes;
 }
 
-template <class t_vector>
-void sdsl_psi_vector<t_vector>::load(std::istream &in)
+template <class t_vector, class t_boundaries>
+void sdsl_psi_vector<t_vector, t_boundaries>::load(std::istream &in)
 {
     read_member(m_size, in);
     read_member(m_alphabet_size,in);
     m_c.resize(m_alphabet_size);
     load_vector(m_c, in);
-    m_alphabet_marker.load(in);
-    m_alphabet_rank = rank_support(&m_alphabet_marker);
-    m_alphabet_select = select_support(&m_alphabet_marker);
+    m_boundaries.load(in);
 }
 
 } // end namespace sdsl
@@ -0,0 +1,52 @@
+import argparse
+import binascii
+import random
+import sys
+
+# Synthetic repetitive DNA in the style of the pseudo-real Pizza&Chili
+# collections (dna.001.1 etc.): copies of a random base sequence, each with
+# a fraction of its symbols mutated. The default of 4.5 GiB exceeds 2^32
+# symbols, which exercises the 64 bit paths of the construction and of the
+# psi vectors (see make MASSIVE_DATA=1).
+
+ALPHABET = bytearray(b"ACGT")
+TO_ALPHABET = bytes(bytearray(ALPHABET[b & 3] for b in range(256)))
+MIB = 1024 * 1024
+
+
+def random_sequence(rng, length):
+    raw = binascii.unhexlify('%0*x' % (2 * length, rng.getrandbits(8 * length)))
+    return bytearray(raw).translate(TO_ALPHABET)
+
+
+def mutate(rng, base, rate):
+    copy = bytearray(base)
+    for _ in range(int(len(copy) * rate)):
+        copy[rng.randint(0, len(copy) - 1)] = ALPHABET[rng.randint(0, 3)]
+    return copy
+
+
+def generate(out, size, base_size, rate, seed):
+    rng = random.Random(seed)
+    base = random_sequence(rng, min(base_size, size))
+    written = 0
+    while written < size:
+        copy = mutate(rng, base, rate)
+        copy = copy[:size - written]
+        out.write(copy)
+        written += len(copy)
+        sys.stderr.write("\r%d of %d MiB" % (written // MIB, size // MIB))
+    sys.stderr.write("\n")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument("output", type=str)
+    parser.add_argument("--size", type=float, default=4.5, help="Size of the text in GiB")
+    parser.add_argument("--base", type=int, default=64, help="Size of the repeated base sequence in MiB")
+    parser.add_argument("--mutation-rate", type=float, default=0.001, help="Fraction of mutated symbols per copy")
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    with open(args.output, "wb") as out:
+        generate(out, int(args.size * 1024 * MIB), args.base * MIB, args.mutation_rate, args.seed)
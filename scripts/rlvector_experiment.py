@@ -7,10 +7,14 @@ import argparse
 import re, sys
 import os, glob
 import shutil
+from collections import OrderedDict
 
 rlvector_benchmark="benchmark/"
 build_dir = "benchmark/build/"
 program = "./executer/rlvector_experiment"
+threads = 1
+ram_budget = 0
+runner_options = []
 
 def exe(cmd):
     try:
@@ -24,21 +28,27 @@ def grep(s,pattern):
     return '\n'.join(re.findall(r'^.*%s.*?$'%pattern,s,flags=re.M))
 
 def execute_rlvector_benchmark(benchmark):
-    cmd = [program,benchmark,build_dir]
+    cmd = [program,benchmark,build_dir,str(threads),str(ram_budget)] + runner_options
     res = exe(cmd)
     return grep(res,'RESULT').split('\n')
 
 
 def get_rlvector_stats(out):
-    res = [str(out.split('Vector=')[1].split()[0])]
-    res += [str(out.split('Benchmark=')[1].split()[0])]
-    res += [float(out.split('ConstructionTime=')[1].split()[0])]
-    res += [float(out.split('SpaceBitsPerElement=')[1].split()[0])]
-    res += [float(out.split('RandomAccessTimePerElement=')[1].split()[0])]
-    res += [float(out.split('SequentialAccessTimePerElement=')[1].split()[0])]   
+    res = OrderedDict()
+    for field in out.split()[1:]:
+        key, value = field.split('=', 1)
+        try: res[key] = float(value)
+        except ValueError: res[key] = value
     return res
 
 
+def get_columns(base_cols, results):
+    cols = list(base_cols)
+    for r in results:
+        cols += [key for key in r.keys() if key not in cols]
+    return cols
+
+
 def delete_folder_content(experiment_dir):
     for root, dirs, files in os.walk(experiment_dir, topdown=False):
         for name in files:
@@ -53,11 +63,42 @@ def seperator(N):
     return sep
 
 
+base_columns = {
+    "rlvector": ["Vector","Benchmark","ConstructionTime","ConstructionPeakRSS","ConstructionPeakHeap",
+                 "ConstructionPeakIntVector","ConstructionAllocations","SpaceBitsPerElement",
+                 "RandomAccessTimePerElement","RandomAccessLatencyP50","RandomAccessLatencyP90",
+                 "RandomAccessLatencyP99","RandomAccessLatencyP999","RandomAccessLatencyMax",
+                 "SequentialAccessTimePerElement"],
+    "pattern": ["Vector","Benchmark","ConstructionTime","ConstructionPeakRSS","ConstructionPeakHeap",
+                "ConstructionPeakIntVector","ConstructionAllocations","SpaceBitsPerSymbol",
+                "PatternLength","CountPatternsPerSecond","CountLatencyP50","CountLatencyP90","CountLatencyP99",
+                "CountLatencyP999","CountLatencyMax","CountedOccurrences","LocatePatternsPerSecond","LocateOccurrencesPerSecond"],
+    "samplerate": ["Vector","Benchmark","SampleRate","ConstructionTime","SpaceBitsPerSymbol",
+                   "ExtractCharsPerSecond","LocateTimePerOccurrence"],
+    "throughput": ["Vector","Benchmark","Threads","QueriesPerSecond","MeanThreadLatency","MaxThreadLatency"],
+    "psiwalk": ["Vector","Benchmark","Chains","Steps","NanosecondsPerStep"],
+    "lfwalk": ["Vector","Benchmark","Chains","Steps","NanosecondsPerStep"],
+    "bitvector": ["Vector","Benchmark","Length","Ones","ConstructionTime","SpaceBitsPerElement",
+                  "RandomAccessTimePerElement","SequentialAccessTimePerElement","Rank0TimePerElement",
+                  "Rank1TimePerElement","Select0TimePerElement","Select1TimePerElement"],
+    "merge": ["Vector","Benchmark","BaseLength","BatchLength","MergeTime","RebuildTime",
+              "MergedSpaceBitsPerElement","RebuiltSpaceBitsPerElement"],
+    "sizeestimate": ["Vector","Benchmark","EstimatedBuckets","MaxEstimateErrorPercent"],
+    "construction": ["Phase","Benchmark","ConstructionThreads","ConstructionTime","LoadTime","SuffixArrayTime",
+                     "BwtTime","RunsTime","PsiTime","ExternalPasses","ExternalIoMiB","ConstructionPeakRSS","ConstructionPeakHeap",
+                     "ConstructionPeakIntVector","ConstructionAllocations","ConstructionAllocated"]
+}
+
+def group_by_experiment(results):
+    groups = OrderedDict()
+    for r in results:
+        name = str(r.pop("Experiment", "rlvector")).lower()
+        groups.setdefault(name, []).append(r)
+    return groups
+
 def experiment(dirname):
     print 'Run-Length Compressed Vector-Experiment\n============'
     rlvector_res = []
-    cols_rlvector = ["Vector","Benchmark","ConstructionTime","SpaceBitsPerElement",
-                    "RandomAccessTimePerElement","SequentialAccessTimePerElement"]
     
     #Create HTML-Folder for Memory-Usage
     try: os.stat("HTML/");
@@ -73,17 +114,17 @@ def experiment(dirname):
         for r in benchmark_res:
             rlvector_res.append(get_rlvector_stats(r));    
             benchmark_rlvector_res.append(get_rlvector_stats(r));
-        df_benchmark_rlvector = pd.DataFrame(benchmark_rlvector_res,columns=cols_rlvector)
-        print(df_benchmark_rlvector)
+        for name, res in group_by_experiment(benchmark_rlvector_res).items():
+            df_benchmark = pd.DataFrame(res,columns=get_columns(base_columns.get(name, []),res))
+            print(df_benchmark)
         
     htmls = glob.glob("HTML/*");
     for html in htmls:
         shutil.move(html,dirname + "/HTML/" + os.path.basename(html))
 
-    cols_rlvector = ["Vector","Benchmark","ConstructionTime","SpaceBitsPerElement",
-                     "RandomAccessTimePerElement","SequentialAccessTimePerElement"]
-    df_rlvector = pd.DataFrame(rlvector_res,columns=cols_rlvector)
-    df_rlvector.to_csv(dirname + '/rlvector_result.csv')
+    for name, res in group_by_experiment(rlvector_res).items():
+        df = pd.DataFrame(res,columns=get_columns(base_columns.get(name, []),res))
+        df.to_csv(dirname + '/' + name + '_result.csv')
     
 
 def setup_experiment_environment():
@@ -103,10 +144,24 @@ def setup_experiment_environment():
 if __name__ == '__main__':
     parser = argparse.ArgumentParser()
     parser.add_argument("--program", type=str);
+    parser.add_argument("--threads", type=int);
+    parser.add_argument("--ram-budget", type=int, help="RAM budget for the psi construction in MiB, 0 builds psi in memory. A larger psi is streamed from disk");
+    parser.add_argument("--select", type=str, help="Comma separated experiments of the runner, see the runner's --list");
+    parser.add_argument("--repetitions", type=int);
+    parser.add_argument("--warmup", type=int);
+    parser.add_argument("--queries", type=int);
+    parser.add_argument("--seed", type=int);
     args = parser.parse_args()
     
     if args.program != None:
         program = args.program
+    if args.threads != None:
+        threads = args.threads
+    if args.ram_budget != None:
+        ram_budget = args.ram_budget
+    for option in ["select", "repetitions", "warmup", "queries", "seed"]:
+        if getattr(args, option) != None:
+            runner_options += ["--" + option, str(getattr(args, option))]
 
     dirname = setup_experiment_environment()
     experiment(dirname)